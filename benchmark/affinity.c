@@ -0,0 +1,142 @@
+#define _GNU_SOURCE
+#include "affinity.h"
+#include "omp.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include <sched.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define CHILD_VARIABLE "OPENMP_BENCHMARK_AFFINITY_CHILD"
+#define MAX_PLACEMENT_THREADS 256
+
+static const char *bindPolicies[] = {"close", "spread", "master"};
+static const char *placeSets[] = {"cores", "threads", "sockets"};
+
+int IsAffinitySweepChild()
+{
+    return getenv(CHILD_VARIABLE) != NULL;
+}
+
+void GetThreadPlacement(int numThreads, char *buffer, size_t size)
+{
+    int cpus[MAX_PLACEMENT_THREADS];
+    if (numThreads > MAX_PLACEMENT_THREADS)
+    {
+        numThreads = MAX_PLACEMENT_THREADS;
+    }
+#pragma omp parallel num_threads(numThreads) shared(cpus) default(none)
+    {
+        cpus[omp_get_thread_num()] = sched_getcpu();
+    }
+
+    size_t used = 0;
+    buffer[0] = '\0';
+    for (int t = 0; t < numThreads && used < size; t++)
+    {
+        used += snprintf(buffer + used, size - used, t == 0 ? "%d" : " %d", cpus[t]);
+    }
+}
+
+/*
+ * Runs one child with the given settings; places may be NULL to leave the
+ * runtime default. The child's header is copied once, data rows always.
+ */
+static int runChild(char *argv[], const char *bind, const char *places, const char *bindLabel,
+                    const char *placesLabel, int *headerWritten, FILE *file)
+{
+    int fds[2];
+    if (pipe(fds) != 0)
+    {
+        perror("pipe");
+        return 1;
+    }
+    fflush(file);
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        perror("fork");
+        close(fds[0]);
+        close(fds[1]);
+        return 1;
+    }
+    if (pid == 0)
+    {
+        dup2(fds[1], STDOUT_FILENO);
+        close(fds[0]);
+        close(fds[1]);
+        setenv(CHILD_VARIABLE, "1", 1);
+        setenv("OMP_PROC_BIND", bind, 1);
+        if (places != NULL)
+        {
+            setenv("OMP_PLACES", places, 1);
+        }
+        else
+        {
+            unsetenv("OMP_PLACES");
+        }
+        execv("/proc/self/exe", argv);
+        perror("execv");
+        _exit(127);
+    }
+
+    close(fds[1]);
+    FILE *output = fdopen(fds[0], "r");
+    char *line = NULL;
+    size_t capacity = 0;
+    int isHeader = 1;
+    while (getline(&line, &capacity, output) != -1)
+    {
+        if (isHeader)
+        {
+            isHeader = 0;
+            if (*headerWritten)
+            {
+                continue;
+            }
+            *headerWritten = 1;
+            fprintf(file, "proc_bind;places;%s", line);
+            continue;
+        }
+        fprintf(file, "%s;%s;%s", bindLabel, placesLabel, line);
+    }
+    free(line);
+    fclose(output);
+
+    int status;
+    waitpid(pid, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+        fprintf(stderr, "Affinity sweep child OMP_PROC_BIND=%s OMP_PLACES=%s failed\n", bindLabel, placesLabel);
+        return 1;
+    }
+    return 0;
+}
+
+int RunAffinitySweep(char *argv[], const char *outPath)
+{
+    FILE *file = strcmp(outPath, "-") == 0 ? stdout : fopen(outPath, "w+");
+    if (file == NULL)
+    {
+        perror(outPath);
+        return 1;
+    }
+    int headerWritten = 0;
+    int failures = 0;
+    for (int b = 0; b < 3; b++)
+    {
+        for (int p = 0; p < 3; p++)
+        {
+            failures += runChild(argv, bindPolicies[b], placeSets[p], bindPolicies[b], placeSets[p], &headerWritten, file);
+        }
+    }
+    // Without binding the places are irrelevant, so unbound runs once.
+    failures += runChild(argv, "false", NULL, "unbound", "none", &headerWritten, file);
+
+    if (file != stdout)
+    {
+        fclose(file);
+    }
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,25 @@
+#ifndef OPENMP_AFFINITY_H
+#define OPENMP_AFFINITY_H
+#endif
+
+#include <stddef.h>
+
+/*
+ * OMP_PROC_BIND and OMP_PLACES are read once when the runtime starts, so
+ * the sweep re-runs the program in a child process per binding policy and
+ * place set and merges the children's CSV rows, prefixed with both
+ * settings, into outPath. Children run with the same arguments and record
+ * where their threads ran.
+ */
+int RunAffinitySweep(char *argv[], const char *outPath);
+
+// True in a child started by RunAffinitySweep.
+int IsAffinitySweepChild();
+
+/*
+ * Writes the CPU every thread of a numThreads team runs on, as a space
+ * separated list in thread number order. It is sampled in a region of its
+ * own right after a measurement, which matches the measured regions when
+ * threads are bound and is only a snapshot otherwise.
+ */
+void GetThreadPlacement(int numThreads, char *buffer, size_t size);
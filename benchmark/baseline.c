@@ -0,0 +1,440 @@
+#include "baseline.h"
+#include "omp.h"
+#include "malloc.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include <unistd.h>
+
+#define MAX_MACHINE_TAG_LENGTH 512
+
+struct BaselineWriter
+{
+    FILE *file;
+    int numResults;
+};
+
+static void readCpuModel(char *buffer, int size)
+{
+    snprintf(buffer, size, "unknown");
+    FILE *cpuinfo = fopen("/proc/cpuinfo", "r");
+    if (cpuinfo == NULL)
+    {
+        return;
+    }
+    char line[512];
+    while (fgets(line, sizeof(line), cpuinfo) != NULL)
+    {
+        char *value = strchr(line, ':');
+        if (strncmp(line, "model name", 10) == 0 && value != NULL)
+        {
+            value += 2;
+            value[strcspn(value, "\n")] = '\0';
+            snprintf(buffer, size, "%s", value);
+            break;
+        }
+    }
+    fclose(cpuinfo);
+}
+
+void GetMachineTag(char *buffer, int size)
+{
+    char host[128] = "unknown";
+    char cpu[256];
+    gethostname(host, sizeof(host) - 1);
+    readCpuModel(cpu, sizeof(cpu));
+#ifdef __VERSION__
+    const char *compiler = __VERSION__;
+#else
+    const char *compiler = "unknown";
+#endif
+    snprintf(buffer, size, "%s | %s | %d procs | %s | OpenMP %d", host, cpu, omp_get_num_procs(), compiler, _OPENMP);
+}
+
+// Names are identifiers, but quotes and backslashes are escaped anyway.
+static void writeString(FILE *file, const char *text)
+{
+    fputc('"', file);
+    for (const char *c = text; *c != '\0'; c++)
+    {
+        if (*c == '"' || *c == '\\')
+        {
+            fputc('\\', file);
+        }
+        fputc(*c, file);
+    }
+    fputc('"', file);
+}
+
+BaselineWriter *OpenBaselineWriter(const char *path)
+{
+    FILE *file = fopen(path, "w+");
+    if (file == NULL)
+    {
+        perror(path);
+        return NULL;
+    }
+    BaselineWriter *writer = malloc(sizeof(BaselineWriter));
+    writer->file = file;
+    writer->numResults = 0;
+
+    char machine[MAX_MACHINE_TAG_LENGTH];
+    GetMachineTag(machine, sizeof(machine));
+    fprintf(file, "{\n  \"machine\": ");
+    writeString(file, machine);
+    fprintf(file, ",\n  \"results\": [");
+    return writer;
+}
+
+void WriteBaselineResult(BaselineWriter *writer, const char *pages, const char *group, const char *method, int size,
+                         int numThreads, double median, const double *samples, int numSamples)
+{
+    FILE *file = writer->file;
+    fprintf(file, "%s\n    {", writer->numResults++ > 0 ? "," : "");
+    if (pages != NULL && *pages != '\0')
+    {
+        fprintf(file, "\"pages\": ");
+        writeString(file, pages);
+        fprintf(file, ", ");
+    }
+    fprintf(file, "\"group\": ");
+    writeString(file, group);
+    fprintf(file, ", \"method\": ");
+    writeString(file, method);
+    fprintf(file, ", \"size\": %d, \"num_threads\": %d, \"median\": %.9g, \"samples\": [", size, numThreads, median);
+    for (int i = 0; i < numSamples; i++)
+    {
+        fprintf(file, i > 0 ? ", %.9g" : "%.9g", samples[i]);
+    }
+    fprintf(file, "]}");
+    fflush(file);
+}
+
+void CloseBaselineWriter(BaselineWriter *writer)
+{
+    fprintf(writer->file, "\n  ]\n}\n");
+    fclose(writer->file);
+    free(writer);
+}
+
+/*
+ * Reader for the subset of JSON the writer produces, tolerant of
+ * whitespace and key order: objects, arrays, strings, numbers. Unknown
+ * keys are skipped.
+ */
+typedef struct Parser
+{
+    const char *cursor;
+    int failed;
+} Parser;
+
+static void skipSpace(Parser *parser)
+{
+    while (*parser->cursor == ' ' || *parser->cursor == '\n' || *parser->cursor == '\r' || *parser->cursor == '\t')
+    {
+        parser->cursor++;
+    }
+}
+
+static int accept(Parser *parser, char expected)
+{
+    skipSpace(parser);
+    if (*parser->cursor != expected)
+    {
+        return 0;
+    }
+    parser->cursor++;
+    return 1;
+}
+
+static void expect(Parser *parser, char expected)
+{
+    if (!accept(parser, expected))
+    {
+        parser->failed = 1;
+    }
+}
+
+static char *parseString(Parser *parser)
+{
+    expect(parser, '"');
+    if (parser->failed)
+    {
+        return NULL;
+    }
+    const char *start = parser->cursor;
+    size_t length = 0;
+    while (start[length] != '"' && start[length] != '\0')
+    {
+        length += start[length] == '\\' && start[length + 1] != '\0' ? 2 : 1;
+    }
+    if (start[length] != '"')
+    {
+        parser->failed = 1;
+        return NULL;
+    }
+    char *text = malloc(length + 1);
+    size_t used = 0;
+    for (size_t i = 0; i < length; i++)
+    {
+        if (start[i] == '\\')
+        {
+            i++;
+        }
+        text[used++] = start[i];
+    }
+    text[used] = '\0';
+    parser->cursor = start + length + 1;
+    return text;
+}
+
+static double parseNumber(Parser *parser)
+{
+    skipSpace(parser);
+    char *end;
+    double value = strtod(parser->cursor, &end);
+    if (end == parser->cursor)
+    {
+        parser->failed = 1;
+    }
+    parser->cursor = end;
+    return value;
+}
+
+static void skipValue(Parser *parser)
+{
+    skipSpace(parser);
+    if (*parser->cursor == '"')
+    {
+        free(parseString(parser));
+    }
+    else if (accept(parser, '[') || accept(parser, '{'))
+    {
+        // Strings are skipped whole, so only nesting has to be tracked.
+        int depth = 1;
+        while (depth > 0 && !parser->failed)
+        {
+            skipSpace(parser);
+            char c = *parser->cursor;
+            if (c == '\0')
+            {
+                parser->failed = 1;
+            }
+            else if (c == '"')
+            {
+                free(parseString(parser));
+            }
+            else
+            {
+                depth += c == '[' || c == '{' ? 1 : c == ']' || c == '}' ? -1 : 0;
+                parser->cursor++;
+            }
+        }
+    }
+    else
+    {
+        while (*parser->cursor != '\0' && strchr(",]} \n\r\t", *parser->cursor) == NULL)
+        {
+            parser->cursor++;
+        }
+    }
+}
+
+static void parseSamples(Parser *parser, BaselineResult *result)
+{
+    int capacity = 16;
+    result->samples = malloc(sizeof(double) * capacity);
+    result->numSamples = 0;
+    expect(parser, '[');
+    if (accept(parser, ']'))
+    {
+        return;
+    }
+    do
+    {
+        if (result->numSamples == capacity)
+        {
+            capacity *= 2;
+            result->samples = realloc(result->samples, sizeof(double) * capacity);
+        }
+        result->samples[result->numSamples++] = parseNumber(parser);
+    } while (!parser->failed && accept(parser, ','));
+    expect(parser, ']');
+}
+
+static void parseResult(Parser *parser, BaselineResult *result)
+{
+    memset(result, 0, sizeof(BaselineResult));
+    expect(parser, '{');
+    if (accept(parser, '}'))
+    {
+        return;
+    }
+    do
+    {
+        char *key = parseString(parser);
+        expect(parser, ':');
+        if (parser->failed)
+        {
+            free(key);
+            return;
+        }
+        if (strcmp(key, "pages") == 0)
+        {
+            result->pages = parseString(parser);
+        }
+        else if (strcmp(key, "group") == 0)
+        {
+            result->group = parseString(parser);
+        }
+        else if (strcmp(key, "method") == 0)
+        {
+            result->method = parseString(parser);
+        }
+        else if (strcmp(key, "size") == 0)
+        {
+            result->size = (int)parseNumber(parser);
+        }
+        else if (strcmp(key, "num_threads") == 0)
+        {
+            result->numThreads = (int)parseNumber(parser);
+        }
+        else if (strcmp(key, "median") == 0)
+        {
+            result->median = parseNumber(parser);
+        }
+        else if (strcmp(key, "samples") == 0)
+        {
+            parseSamples(parser, result);
+        }
+        else
+        {
+            skipValue(parser);
+        }
+        free(key);
+    } while (!parser->failed && accept(parser, ','));
+    expect(parser, '}');
+    if (result->group == NULL || result->method == NULL || result->numSamples == 0)
+    {
+        parser->failed = 1;
+    }
+}
+
+static void parseResults(Parser *parser, Baseline *baseline)
+{
+    int capacity = 64;
+    baseline->results = malloc(sizeof(BaselineResult) * capacity);
+    expect(parser, '[');
+    if (accept(parser, ']'))
+    {
+        return;
+    }
+    do
+    {
+        if (baseline->numResults == capacity)
+        {
+            capacity *= 2;
+            baseline->results = realloc(baseline->results, sizeof(BaselineResult) * capacity);
+        }
+        parseResult(parser, &baseline->results[baseline->numResults++]);
+    } while (!parser->failed && accept(parser, ','));
+    expect(parser, ']');
+}
+
+static char *readFile(const char *path)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+    {
+        perror(path);
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char *text = malloc(length + 1);
+    size_t numRead = fread(text, 1, length, file);
+    text[numRead] = '\0';
+    fclose(file);
+    return text;
+}
+
+Baseline *LoadBaseline(const char *path)
+{
+    char *text = readFile(path);
+    if (text == NULL)
+    {
+        return NULL;
+    }
+    Baseline *baseline = calloc(1, sizeof(Baseline));
+    Parser parser = {.cursor = text, .failed = 0};
+    expect(&parser, '{');
+    if (!accept(&parser, '}'))
+    {
+        do
+        {
+            char *key = parseString(&parser);
+            expect(&parser, ':');
+            if (parser.failed)
+            {
+                free(key);
+                break;
+            }
+            if (strcmp(key, "machine") == 0)
+            {
+                baseline->machine = parseString(&parser);
+            }
+            else if (strcmp(key, "results") == 0)
+            {
+                parseResults(&parser, baseline);
+            }
+            else
+            {
+                skipValue(&parser);
+            }
+            free(key);
+        } while (!parser.failed && accept(&parser, ','));
+        expect(&parser, '}');
+    }
+    if (parser.failed)
+    {
+        fprintf(stderr, "%s: malformed baseline near offset %ld\n", path, (long)(parser.cursor - text));
+        FreeBaseline(baseline);
+        baseline = NULL;
+    }
+    free(text);
+    return baseline;
+}
+
+const BaselineResult *FindBaselineResult(const Baseline *baseline, const char *pages, const char *group,
+                                         const char *method, int size, int numThreads)
+{
+    for (int i = 0; i < baseline->numResults; i++)
+    {
+        const BaselineResult *result = &baseline->results[i];
+        if (result->size == size && result->numThreads == numThreads && strcmp(result->group, group) == 0 &&
+            strcmp(result->method, method) == 0 &&
+            strcmp(result->pages != NULL ? result->pages : "", pages != NULL ? pages : "") == 0)
+        {
+            return result;
+        }
+    }
+    return NULL;
+}
+
+void FreeBaseline(Baseline *baseline)
+{
+    if (baseline->results != NULL)
+    {
+        for (int i = 0; i < baseline->numResults; i++)
+        {
+            free(baseline->results[i].pages);
+            free(baseline->results[i].group);
+            free(baseline->results[i].method);
+            free(baseline->results[i].samples);
+        }
+        free(baseline->results);
+    }
+    free(baseline->machine);
+    free(baseline);
+}
@@ -0,0 +1,49 @@
+#ifndef OPENMP_BASELINE_H
+#define OPENMP_BASELINE_H
+#endif
+
+/*
+ * Stored results for regression checks: a JSON document with a machine
+ * tag (host, CPU model, processor count, compiler, OpenMP version) and,
+ * per page kind, group, method, size and thread count, the median and the
+ * raw timed samples in milliseconds. The page kind is only stored for
+ * --pages runs; NULL or "" stands for the default allocation.
+ */
+typedef struct BaselineResult
+{
+    char *pages;
+    char *group;
+    char *method;
+    int size;
+    int numThreads;
+    double median;
+    int numSamples;
+    double *samples;
+} BaselineResult;
+
+typedef struct Baseline
+{
+    char *machine;
+    int numResults;
+    BaselineResult *results;
+} Baseline;
+
+typedef struct BaselineWriter BaselineWriter;
+
+BaselineWriter *OpenBaselineWriter(const char *path);
+
+void WriteBaselineResult(BaselineWriter *writer, const char *pages, const char *group, const char *method, int size,
+                         int numThreads, double median, const double *samples, int numSamples);
+
+void CloseBaselineWriter(BaselineWriter *writer);
+
+// Returns NULL, after printing why, if path is missing or malformed.
+Baseline *LoadBaseline(const char *path);
+
+const BaselineResult *FindBaselineResult(const Baseline *baseline, const char *pages, const char *group,
+                                         const char *method, int size, int numThreads);
+
+// Machine tag of the running host, in the form stored in baselines.
+void GetMachineTag(char *buffer, int size);
+
+void FreeBaseline(Baseline *baseline);
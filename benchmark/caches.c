@@ -0,0 +1,99 @@
+#include "caches.h"
+#include "omp.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+
+#define CACHE_DIRECTORY "/sys/devices/system/cpu/cpu0/cache"
+
+static int readCacheFile(int index, const char *name, char *buffer, int size)
+{
+    char path[128];
+    snprintf(path, sizeof(path), CACHE_DIRECTORY "/index%d/%s", index, name);
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+    {
+        return 1;
+    }
+    int failed = fgets(buffer, size, file) == NULL;
+    fclose(file);
+    buffer[strcspn(buffer, "\n")] = '\0';
+    return failed;
+}
+
+// Number of CPUs in a list like "0-3,8-11".
+static int countCpus(const char *list)
+{
+    int count = 0;
+    const char *cursor = list;
+    while (*cursor != '\0')
+    {
+        char *end;
+        long first = strtol(cursor, &end, 10);
+        long last = first;
+        if (end == cursor)
+        {
+            break;
+        }
+        if (*end == '-')
+        {
+            cursor = end + 1;
+            last = strtol(cursor, &end, 10);
+        }
+        count += (int)(last - first + 1);
+        cursor = *end == ',' ? end + 1 : end;
+    }
+    return count > 0 ? count : 1;
+}
+
+int GetCacheLevels(CacheLevel *levels, int maxLevels)
+{
+    int numLevels = 0;
+    char buffer[256];
+    for (int index = 0; numLevels < maxLevels && readCacheFile(index, "level", buffer, sizeof(buffer)) == 0; index++)
+    {
+        int level = atoi(buffer);
+        char type[32];
+        if (readCacheFile(index, "type", type, sizeof(type)) != 0 || strcmp(type, "Instruction") == 0 ||
+            readCacheFile(index, "size", buffer, sizeof(buffer)) != 0)
+        {
+            continue;
+        }
+        char *unit;
+        long long size = strtoll(buffer, &unit, 10);
+        size *= *unit == 'K' ? 1024 : *unit == 'M' ? 1024 * 1024 : *unit == 'G' ? 1024 * 1024 * 1024 : 1;
+        int cpus = readCacheFile(index, "shared_cpu_list", buffer, sizeof(buffer)) == 0 ? countCpus(buffer) : 1;
+        levels[numLevels++] = (CacheLevel){.level = level, .size = size, .cpusPerInstance = cpus};
+    }
+    return numLevels;
+}
+
+const char *GetWorkingSetLevel(double bytes, int numThreads)
+{
+    static CacheLevel levels[MAX_CACHE_LEVELS];
+    static int numLevels = -1;
+    static const char *names[] = {"L0", "L1", "L2", "L3", "L4"};
+    if (numLevels < 0)
+    {
+        numLevels = GetCacheLevels(levels, MAX_CACHE_LEVELS);
+    }
+    if (numLevels == 0)
+    {
+        return "NA";
+    }
+    int numCpus = omp_get_num_procs();
+    for (int i = 0; i < numLevels; i++)
+    {
+        int instances = (numThreads + levels[i].cpusPerInstance - 1) / levels[i].cpusPerInstance;
+        int maxInstances = (numCpus + levels[i].cpusPerInstance - 1) / levels[i].cpusPerInstance;
+        if (instances > maxInstances)
+        {
+            instances = maxInstances;
+        }
+        if (bytes <= (double)levels[i].size * instances)
+        {
+            return levels[i].level >= 0 && levels[i].level <= 4 ? names[levels[i].level] : "cache";
+        }
+    }
+    return "DRAM";
+}
@@ -0,0 +1,27 @@
+#ifndef OPENMP_CACHES_H
+#define OPENMP_CACHES_H
+#endif
+
+#define MAX_CACHE_LEVELS 8
+
+/*
+ * Data and unified caches of cpu0 as listed in sysfs, innermost first.
+ * cpusPerInstance is the number of CPUs sharing one instance.
+ */
+typedef struct CacheLevel
+{
+    int level;
+    long long size;
+    int cpusPerInstance;
+} CacheLevel;
+
+// Returns the number of levels found, 0 without sysfs cache information.
+int GetCacheLevels(CacheLevel *levels, int maxLevels);
+
+/*
+ * Innermost level ("L1", "L2", ...) whose combined capacity holds bytes,
+ * "DRAM" if none does, or "NA" when the caches are unknown. A team of
+ * numThreads threads is assumed to be packed onto as few instances of
+ * each level as possible.
+ */
+const char *GetWorkingSetLevel(double bytes, int numThreads);
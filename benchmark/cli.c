@@ -0,0 +1,539 @@
+#include "cli.h"
+#include "affinity.h"
+#include "resultSink.h"
+#include "roofline.h"
+#include "service.h"
+#include "waitPolicy.h"
+#include "../datatypes/hugePages.h"
+#include "omp.h"
+#include "limits.h"
+#include "math.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include <getopt.h>
+
+#define DEFAULT_REGRESSION_THRESHOLD 0.05
+#define DEFAULT_SIGNIFICANCE 0.01
+#define DEFAULT_SWEEP_STEPS 4
+
+void PrintUsage(const char *program)
+{
+    const MeasurementConfig defaults = GetDefaultMeasurementConfig();
+    fprintf(stderr,
+            "Usage: %s <task>\n"
+            "       %s [--list] [--bench PATTERNS] [--sizes LIST | --size-sweep MIN-MAX]\n"
+            "          [--sweep-steps N] [--threads LIST] [--weak-scaling]\n"
+            "          [--warmup N] [--reps N] [--max-reps N] [--rel-error E] [--max-time MS]\n"
+            "          [--roofline] [--counters] [--placement] [--cpu-time] [--affinity]\n"
+            "          [--wait-policy] [--pages LIST] [--baseline PATH] [--compare PATH]\n"
+            "          [--threshold R] [--significance P] [--format csv|binary] [--out PATH]\n"
+            "       %s --convert PATH [--out PATH]\n"
+            "       %s --serve PATH [--threads N]\n"
+            "\n"
+            "  <task>            legacy comparison: 1-6, 9, B-F\n"
+            "  --list            print the registered benchmarks matching --bench and exit\n"
+            "  --bench PATTERNS  comma separated shell patterns over group or group/method\n"
+            "  --sizes LIST      problem sizes, e.g. 100,1e5,1e8 (default: per group)\n"
+            "  --size-sweep MIN-MAX\n"
+            "                    geometric sizes from MIN to MAX, e.g. 1e3-1e8, with a working_set\n"
+            "                    column naming the cache level that holds one call's bytes\n"
+            "  --sweep-steps N   sizes per doubling in --size-sweep (default: %d)\n"
+            "  --threads LIST    thread counts, e.g. 1,2,4 or 2-16 (default: 1-%d)\n"
+            "  --weak-scaling    sizes are per thread: t threads run size * t, with the\n"
+            "                    efficiency against the first thread count\n"
+            "  --warmup N        untimed calls before measuring (default: %d)\n"
+            "  --reps N          minimum timed calls per configuration (default: %d)\n"
+            "  --max-reps N      maximum timed calls per configuration (default: %d)\n"
+            "  --rel-error E     stop once the 95%% CI is within E of the mean (default: %g)\n"
+            "  --max-time MS     time budget of one configuration (default: %g)\n"
+            "  --roofline        measure the STREAM and FMA ceilings first for percent_of_peak\n"
+            "  --counters        record cycles, instructions, LLC, branch and dTLB misses per call\n"
+            "  --placement       record the CPU every thread ran on\n"
+            "  --cpu-time        record the CPU time of every call, summed over the threads,\n"
+            "                    and the team size the runtime granted\n"
+            "  --affinity        repeat the run for every OMP_PROC_BIND (close, spread, master,\n"
+            "                    unbound) and OMP_PLACES (cores, threads, sockets) setting\n"
+            "  --wait-policy     repeat the run for every OMP_WAIT_POLICY, GOMP_SPINCOUNT or\n"
+            "                    KMP_BLOCKTIME, and OMP_DYNAMIC setting; implies --cpu-time\n"
+            "  --pages LIST      repeat the run with large arrays on malloc, 4k, thp, 2m or 1g\n"
+            "                    pages, e.g. 4k,thp,2m; implies --counters for the dTLB misses\n"
+            "                    and skips sizes whose arrays did not get these pages\n"
+            "  --baseline PATH   store the results with a machine tag as JSON\n"
+            "  --compare PATH    compare with a stored baseline, exit with 1 on regressions\n"
+            "  --threshold R     relative median slowdown that counts as a regression (default: %g)\n"
+            "  --significance P  Mann-Whitney p-value below which a change is real (default: %g)\n"
+            "  --format FORMAT   csv, or binary for the compact columnar format (default: csv)\n"
+            "  --out PATH        result output, '-' for stdout with csv (default: -)\n"
+            "  --convert PATH    write a binary result file as CSV to --out and exit\n"
+            "  --serve PATH      answer kernel requests on a Unix socket, or stdin with '-',\n"
+            "                    with a warm team of the largest --threads count (see service.h)\n",
+            program, program, program, program, DEFAULT_SWEEP_STEPS, omp_get_num_procs(), defaults.warmupRuns, defaults.minRepetitions,
+            defaults.maxRepetitions, defaults.targetRelativeError, defaults.maxTotalTime, DEFAULT_REGRESSION_THRESHOLD,
+            DEFAULT_SIGNIFICANCE);
+}
+
+/*
+ * Parses a comma separated list of numbers and inclusive ranges (a-b).
+ * Numbers may use exponent notation (1e8) but must be integers that fit an
+ * int. Returns the number of values or -1 if the list is malformed or
+ * longer than maxValues.
+ */
+int ParseIntList(const char *text, int *values, int maxValues)
+{
+    int count = 0;
+    const char *cursor = text;
+    while (*cursor != '\0')
+    {
+        char *end;
+        double first = strtod(cursor, &end);
+        if (end == cursor)
+        {
+            return -1;
+        }
+        double last = first;
+        if (*end == '-')
+        {
+            cursor = end + 1;
+            last = strtod(cursor, &end);
+            if (end == cursor || last < first)
+            {
+                return -1;
+            }
+        }
+        if (first != floor(first) || last != floor(last) || last > INT_MAX)
+        {
+            return -1;
+        }
+        for (long long value = (long long)first; value <= (long long)last; value++)
+        {
+            if (count == maxValues || value <= 0)
+            {
+                return -1;
+            }
+            values[count++] = (int)value;
+        }
+        if (*end == ',')
+        {
+            end++;
+        }
+        else if (*end != '\0')
+        {
+            return -1;
+        }
+        cursor = end;
+    }
+    return count;
+}
+
+/*
+ * Sizes MIN * 2^(k / steps) up to MAX from "MIN-MAX", rounded and without
+ * repeats, so small ranges do not produce the same size twice. Returns
+ * their number or -1.
+ */
+static int makeSizeSweep(const char *text, int steps, int *sizes, int maxSizes)
+{
+    char *end;
+    double first = strtod(text, &end);
+    if (end == text || *end != '-' || first < 1)
+    {
+        return -1;
+    }
+    const char *cursor = end + 1;
+    double last = strtod(cursor, &end);
+    if (end == cursor || *end != '\0' || last < first || last > INT_MAX)
+    {
+        return -1;
+    }
+    int count = 0;
+    for (int k = 0;; k++)
+    {
+        double size = round(first * pow(2, (double)k / steps));
+        if (size > last)
+        {
+            break;
+        }
+        if (count > 0 && (int)size == sizes[count - 1])
+        {
+            continue;
+        }
+        if (count == maxSizes)
+        {
+            return -1;
+        }
+        sizes[count++] = (int)size;
+    }
+    return count;
+}
+
+// Comma separated page kind names; returns their number or -1.
+static int parsePageKinds(const char *text, int *kinds)
+{
+    char name[16];
+    int count = 0;
+    const char *start = text;
+    while (*start != '\0')
+    {
+        const char *end = strchr(start, ',');
+        size_t length = end == NULL ? strlen(start) : (size_t)(end - start);
+        PageKind kind;
+        if (length >= sizeof(name) || count == MAX_PAGE_KINDS)
+        {
+            return -1;
+        }
+        memcpy(name, start, length);
+        name[length] = '\0';
+        if (ParsePageKind(name, &kind) != 0)
+        {
+            return -1;
+        }
+        kinds[count++] = kind;
+        if (end == NULL)
+        {
+            break;
+        }
+        start = end + 1;
+    }
+    return count;
+}
+
+int ParseBenchmarkArguments(int argc, char *argv[], BenchmarkConfig *config, int *listOnly)
+{
+    static const struct option options[] = {
+        {"list", no_argument, NULL, 'l'},
+        {"bench", required_argument, NULL, 'b'},
+        {"sizes", required_argument, NULL, 's'},
+        {"threads", required_argument, NULL, 't'},
+        {"size-sweep", required_argument, NULL, 'G'},
+        {"sweep-steps", required_argument, NULL, 'g'},
+        {"weak-scaling", no_argument, NULL, 'W'},
+        {"warmup", required_argument, NULL, 'w'},
+        {"reps", required_argument, NULL, 'r'},
+        {"max-reps", required_argument, NULL, 'm'},
+        {"rel-error", required_argument, NULL, 'e'},
+        {"max-time", required_argument, NULL, 'T'},
+        {"roofline", no_argument, NULL, 'L'},
+        {"counters", no_argument, NULL, 'c'},
+        {"placement", no_argument, NULL, 'p'},
+        {"cpu-time", no_argument, NULL, 'u'},
+        {"affinity", no_argument, NULL, 'a'},
+        {"wait-policy", no_argument, NULL, 'y'},
+        {"pages", required_argument, NULL, 'P'},
+        {"baseline", required_argument, NULL, 'B'},
+        {"compare", required_argument, NULL, 'C'},
+        {"threshold", required_argument, NULL, 'R'},
+        {"significance", required_argument, NULL, 'S'},
+        {"format", required_argument, NULL, 'f'},
+        {"out", required_argument, NULL, 'o'},
+        {"convert", required_argument, NULL, 'x'},
+        {"serve", required_argument, NULL, 'v'},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0}};
+
+    config->filter = NULL;
+    config->numSizes = 0;
+    config->weakScaling = 0;
+    config->scalingColumns = 0;
+    config->numThreadCounts = 0;
+    config->measurement = GetDefaultMeasurementConfig();
+    config->measureRoofline = 0;
+    config->collectCounters = 0;
+    config->recordPlacement = 0;
+    config->recordCpuTime = 0;
+    config->sweepAffinity = 0;
+    config->sweepWaitPolicy = 0;
+    config->numPageKinds = 0;
+    config->baselinePath = NULL;
+    config->comparePath = NULL;
+    config->regressionThreshold = DEFAULT_REGRESSION_THRESHOLD;
+    config->significance = DEFAULT_SIGNIFICANCE;
+    config->outPath = "-";
+    config->binaryOutput = 0;
+    config->convertPath = NULL;
+    config->servePath = NULL;
+    *listOnly = 0;
+
+    const char *sweep = NULL;
+    int sweepSteps = DEFAULT_SWEEP_STEPS;
+    int option;
+    optind = 1;
+    while ((option = getopt_long(argc, argv, "", options, NULL)) != -1)
+    {
+        switch (option)
+        {
+        case 'l':
+            *listOnly = 1;
+            break;
+        case 'b':
+            config->filter = optarg;
+            break;
+        case 's':
+            config->numSizes = ParseIntList(optarg, config->sizes, MAX_SIZES);
+            if (config->numSizes <= 0)
+            {
+                fprintf(stderr, "Invalid --sizes: %s\n", optarg);
+                return -1;
+            }
+            break;
+        case 't':
+            config->numThreadCounts = ParseIntList(optarg, config->threadCounts, MAX_THREAD_COUNTS);
+            if (config->numThreadCounts <= 0)
+            {
+                fprintf(stderr, "Invalid --threads: %s\n", optarg);
+                return -1;
+            }
+            break;
+        case 'w':
+            config->measurement.warmupRuns = atoi(optarg);
+            if (config->measurement.warmupRuns < 0)
+            {
+                fprintf(stderr, "Invalid --warmup: %s\n", optarg);
+                return -1;
+            }
+            break;
+        case 'r':
+            config->measurement.minRepetitions = atoi(optarg);
+            if (config->measurement.minRepetitions <= 0)
+            {
+                fprintf(stderr, "Invalid --reps: %s\n", optarg);
+                return -1;
+            }
+            break;
+        case 'm':
+            config->measurement.maxRepetitions = atoi(optarg);
+            if (config->measurement.maxRepetitions <= 0)
+            {
+                fprintf(stderr, "Invalid --max-reps: %s\n", optarg);
+                return -1;
+            }
+            break;
+        case 'e':
+            config->measurement.targetRelativeError = atof(optarg);
+            if (config->measurement.targetRelativeError <= 0)
+            {
+                fprintf(stderr, "Invalid --rel-error: %s\n", optarg);
+                return -1;
+            }
+            break;
+        case 'T':
+            config->measurement.maxTotalTime = atof(optarg);
+            if (config->measurement.maxTotalTime <= 0)
+            {
+                fprintf(stderr, "Invalid --max-time: %s\n", optarg);
+                return -1;
+            }
+            break;
+        case 'L':
+            config->measureRoofline = 1;
+            break;
+        case 'c':
+            config->collectCounters = 1;
+            break;
+        case 'p':
+            config->recordPlacement = 1;
+            break;
+        case 'u':
+            config->recordCpuTime = 1;
+            break;
+        case 'a':
+            config->sweepAffinity = 1;
+            break;
+        case 'y':
+            config->sweepWaitPolicy = 1;
+            config->recordCpuTime = 1;
+            break;
+        case 'P':
+            config->numPageKinds = parsePageKinds(optarg, config->pageKinds);
+            if (config->numPageKinds <= 0)
+            {
+                fprintf(stderr, "Invalid --pages: %s\n", optarg);
+                return -1;
+            }
+            config->collectCounters = 1;
+            break;
+        case 'B':
+            config->baselinePath = optarg;
+            break;
+        case 'C':
+            config->comparePath = optarg;
+            break;
+        case 'R':
+            config->regressionThreshold = atof(optarg);
+            if (config->regressionThreshold < 0)
+            {
+                fprintf(stderr, "Invalid --threshold: %s\n", optarg);
+                return -1;
+            }
+            break;
+        case 'S':
+            config->significance = atof(optarg);
+            if (config->significance <= 0 || config->significance >= 1)
+            {
+                fprintf(stderr, "Invalid --significance: %s\n", optarg);
+                return -1;
+            }
+            break;
+        case 'f':
+            if (strcmp(optarg, "csv") != 0 && strcmp(optarg, "binary") != 0)
+            {
+                fprintf(stderr, "Invalid --format: %s\n", optarg);
+                return -1;
+            }
+            config->binaryOutput = strcmp(optarg, "binary") == 0;
+            break;
+        case 'o':
+            config->outPath = optarg;
+            break;
+        case 'x':
+            config->convertPath = optarg;
+            break;
+        case 'v':
+            config->servePath = optarg;
+            break;
+        case 'G':
+            sweep = optarg;
+            break;
+        case 'g':
+            sweepSteps = atoi(optarg);
+            if (sweepSteps <= 0)
+            {
+                fprintf(stderr, "Invalid --sweep-steps: %s\n", optarg);
+                return -1;
+            }
+            break;
+        case 'W':
+            config->weakScaling = 1;
+            config->scalingColumns = 1;
+            break;
+        default:
+            return -1;
+        }
+    }
+    if (optind < argc)
+    {
+        fprintf(stderr, "Unexpected argument: %s\n", argv[optind]);
+        return -1;
+    }
+    if (sweep != NULL)
+    {
+        if (config->numSizes > 0)
+        {
+            fprintf(stderr, "--sizes and --size-sweep are exclusive\n");
+            return -1;
+        }
+        config->numSizes = makeSizeSweep(sweep, sweepSteps, config->sizes, MAX_SIZES);
+        if (config->numSizes <= 0)
+        {
+            fprintf(stderr, "Invalid --size-sweep: %s\n", sweep);
+            return -1;
+        }
+        config->scalingColumns = 1;
+    }
+
+    if (config->numThreadCounts == 0)
+    {
+        const int maxThreads = omp_get_num_procs();
+        for (int i = 0; i < maxThreads && i < MAX_THREAD_COUNTS; i++)
+        {
+            config->threadCounts[config->numThreadCounts++] = i + 1;
+        }
+    }
+    return 0;
+}
+
+static void listBenchmarks(const char *filter)
+{
+    for (int i = 0; i < GetBenchmarkCount(); i++)
+    {
+        const Benchmark *benchmark = GetBenchmark(i);
+        if (MatchesBenchmarkFilter(benchmark, filter))
+        {
+            printf("%s/%s%s\n", benchmark->group->name, benchmark->method, benchmark->isParallel ? "" : " (serial)");
+        }
+    }
+}
+
+int RunBenchmarkCli(int argc, char *argv[])
+{
+    BenchmarkConfig config;
+    int listOnly;
+    if (ParseBenchmarkArguments(argc, argv, &config, &listOnly) != 0)
+    {
+        PrintUsage(argv[0]);
+        return 2;
+    }
+    if (listOnly)
+    {
+        listBenchmarks(config.filter);
+        return 0;
+    }
+    if (config.convertPath != NULL)
+    {
+        return ConvertResultFile(config.convertPath, config.outPath);
+    }
+    if (config.servePath != NULL)
+    {
+        int maxThreads = config.threadCounts[0];
+        for (int t = 1; t < config.numThreadCounts; t++)
+        {
+            if (config.threadCounts[t] > maxThreads)
+            {
+                maxThreads = config.threadCounts[t];
+            }
+        }
+        return RunService(config.servePath, maxThreads);
+    }
+    if (config.sweepAffinity && config.sweepWaitPolicy)
+    {
+        fprintf(stderr, "--affinity and --wait-policy are exclusive\n");
+        return 2;
+    }
+    if (config.sweepAffinity)
+    {
+        if (config.binaryOutput)
+        {
+            fprintf(stderr, "--affinity merges CSV rows and cannot write --format binary\n");
+            return 2;
+        }
+        // Every child would rewrite or compare the baseline on its own.
+        if (config.baselinePath != NULL || config.comparePath != NULL)
+        {
+            fprintf(stderr, "--affinity cannot be combined with --baseline or --compare\n");
+            return 2;
+        }
+        if (!IsAffinitySweepChild())
+        {
+            if (config.measureRoofline)
+            {
+                ShareRooflinePeaks(omp_get_num_procs());
+            }
+            return RunAffinitySweep(argv, config.outPath);
+        }
+        // Children report to the sweeping parent through stdout.
+        config.recordPlacement = 1;
+        config.outPath = "-";
+    }
+    if (config.sweepWaitPolicy)
+    {
+        if (config.binaryOutput)
+        {
+            fprintf(stderr, "--wait-policy merges CSV rows and cannot write --format binary\n");
+            return 2;
+        }
+        if (config.baselinePath != NULL || config.comparePath != NULL)
+        {
+            fprintf(stderr, "--wait-policy cannot be combined with --baseline or --compare\n");
+            return 2;
+        }
+        if (!IsWaitPolicySweepChild())
+        {
+            if (config.measureRoofline)
+            {
+                ShareRooflinePeaks(omp_get_num_procs());
+            }
+            return RunWaitPolicySweep(argv, config.outPath);
+        }
+        config.outPath = "-";
+    }
+    return RunBenchmarks(&config);
+}
@@ -0,0 +1,14 @@
+#ifndef OPENMP_CLI_H
+#define OPENMP_CLI_H
+#endif
+
+#include "registry.h"
+
+void PrintUsage(const char *program);
+
+// Values of a list like "100,1e5,2-8"; returns their number or -1.
+int ParseIntList(const char *text, int *values, int maxValues);
+
+int ParseBenchmarkArguments(int argc, char *argv[], BenchmarkConfig *config, int *listOnly);
+
+int RunBenchmarkCli(int argc, char *argv[]);
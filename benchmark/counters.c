@@ -0,0 +1,217 @@
+#include "counters.h"
+#include "omp.h"
+#include "malloc.h"
+#include "stdio.h"
+#include "string.h"
+
+#ifdef __linux__
+#include <errno.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+struct CounterSet
+{
+    int numThreads;
+    int *fds;
+};
+
+// Reported once per process so a restricted host does not flood stderr.
+static int warnedUnavailable = 0;
+
+const char *GetCounterName(CounterKind kind)
+{
+    switch (kind)
+    {
+    case COUNTER_CYCLES:
+        return "cycles";
+    case COUNTER_INSTRUCTIONS:
+        return "instructions";
+    case COUNTER_LLC_MISSES:
+        return "llc_misses";
+    case COUNTER_BRANCH_MISSES:
+        return "branch_misses";
+    case COUNTER_DTLB_MISSES:
+        return "dtlb_misses";
+    default:
+        return "unknown";
+    }
+}
+
+#ifdef __linux__
+
+static void describeCounter(CounterKind kind, struct perf_event_attr *attr)
+{
+    memset(attr, 0, sizeof(*attr));
+    attr->size = sizeof(*attr);
+    attr->disabled = 1;
+    attr->exclude_kernel = 1;
+    attr->exclude_hv = 1;
+    attr->read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    switch (kind)
+    {
+    case COUNTER_CYCLES:
+        attr->type = PERF_TYPE_HARDWARE;
+        attr->config = PERF_COUNT_HW_CPU_CYCLES;
+        break;
+    case COUNTER_INSTRUCTIONS:
+        attr->type = PERF_TYPE_HARDWARE;
+        attr->config = PERF_COUNT_HW_INSTRUCTIONS;
+        break;
+    case COUNTER_LLC_MISSES:
+        attr->type = PERF_TYPE_HW_CACHE;
+        attr->config = PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                       (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        break;
+    case COUNTER_BRANCH_MISSES:
+        attr->type = PERF_TYPE_HARDWARE;
+        attr->config = PERF_COUNT_HW_BRANCH_MISSES;
+        break;
+    case COUNTER_DTLB_MISSES:
+        attr->type = PERF_TYPE_HW_CACHE;
+        attr->config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                       (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        break;
+    default:
+        break;
+    }
+}
+
+static int openCounter(CounterKind kind)
+{
+    struct perf_event_attr attr;
+    describeCounter(kind, &attr);
+    // pid 0 and cpu -1: the calling thread, on whatever CPU it runs.
+    int fd = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+    if (fd < 0 && !__atomic_exchange_n(&warnedUnavailable, 1, __ATOMIC_RELAXED))
+    {
+        fprintf(stderr, "perf_event_open(%s): %s, unavailable counters are reported as NA\n",
+                GetCounterName(kind), strerror(errno));
+    }
+    return fd;
+}
+
+CounterSet *OpenCounters(int numThreads)
+{
+    CounterSet *counters = malloc(sizeof(CounterSet));
+    counters->numThreads = numThreads;
+    counters->fds = malloc(sizeof(int) * numThreads * COUNTER_KIND_COUNT);
+    for (int i = 0; i < numThreads * COUNTER_KIND_COUNT; i++)
+    {
+        counters->fds[i] = -1;
+    }
+    // The runtime keeps its pool threads between regions of the same size,
+    // so the threads opening the counters are the ones running the kernel.
+#pragma omp parallel num_threads(numThreads) shared(counters) default(none)
+    {
+        int *fds = counters->fds + omp_get_thread_num() * COUNTER_KIND_COUNT;
+        for (CounterKind kind = 0; kind < COUNTER_KIND_COUNT; kind++)
+        {
+            fds[kind] = openCounter(kind);
+        }
+    }
+    return counters;
+}
+
+static void controlCounters(CounterSet *counters, unsigned long request)
+{
+    for (int i = 0; i < counters->numThreads * COUNTER_KIND_COUNT; i++)
+    {
+        if (counters->fds[i] >= 0)
+        {
+            ioctl(counters->fds[i], request, 0);
+        }
+    }
+}
+
+void StartCounters(CounterSet *counters)
+{
+    controlCounters(counters, PERF_EVENT_IOC_ENABLE);
+}
+
+void StopCounters(CounterSet *counters)
+{
+    controlCounters(counters, PERF_EVENT_IOC_DISABLE);
+}
+
+CounterValues ReadCounters(CounterSet *counters, int numCalls)
+{
+    CounterValues result;
+    for (CounterKind kind = 0; kind < COUNTER_KIND_COUNT; kind++)
+    {
+        result.available[kind] = 0;
+        result.values[kind] = 0;
+        for (int t = 0; t < counters->numThreads; t++)
+        {
+            int fd = counters->fds[t * COUNTER_KIND_COUNT + kind];
+            unsigned long long data[3];
+            if (fd < 0 || read(fd, data, sizeof(data)) != sizeof(data))
+            {
+                continue;
+            }
+            // data: value, time enabled, time running. An event that was
+            // multiplexed out the whole time has no estimate, not zero.
+            if (data[2] > 0)
+            {
+                result.available[kind] = 1;
+                result.values[kind] += (double)data[0] * data[1] / data[2];
+            }
+        }
+        if (numCalls > 0)
+        {
+            result.values[kind] /= numCalls;
+        }
+    }
+    return result;
+}
+
+void CloseCounters(CounterSet *counters)
+{
+    for (int i = 0; i < counters->numThreads * COUNTER_KIND_COUNT; i++)
+    {
+        if (counters->fds[i] >= 0)
+        {
+            close(counters->fds[i]);
+        }
+    }
+    free(counters->fds);
+    free(counters);
+}
+
+#else
+
+CounterSet *OpenCounters(int numThreads)
+{
+    if (!warnedUnavailable)
+    {
+        warnedUnavailable = 1;
+        fprintf(stderr, "Hardware counters need perf_event_open, reporting them as NA\n");
+    }
+    CounterSet *counters = malloc(sizeof(CounterSet));
+    counters->numThreads = 0;
+    counters->fds = NULL;
+    return counters;
+}
+
+void StartCounters(CounterSet *counters)
+{
+}
+
+void StopCounters(CounterSet *counters)
+{
+}
+
+CounterValues ReadCounters(CounterSet *counters, int numCalls)
+{
+    CounterValues result = {{0}};
+    return result;
+}
+
+void CloseCounters(CounterSet *counters)
+{
+    free(counters);
+}
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef OPENMP_COUNTERS_H
+#define OPENMP_COUNTERS_H
+#endif
+
+typedef enum CounterKind
+{
+    COUNTER_CYCLES,
+    COUNTER_INSTRUCTIONS,
+    COUNTER_LLC_MISSES,
+    COUNTER_BRANCH_MISSES,
+    COUNTER_DTLB_MISSES,
+    COUNTER_KIND_COUNT
+} CounterKind;
+
+/*
+ * Hardware counters of an OpenMP thread team, opened with perf_event_open
+ * once per team thread so the kernel's worker threads are counted, not just
+ * the calling one. Nested teams are not covered. Counters that cannot be
+ * opened (perf_event_paranoid, no PMU in a VM, non-Linux) are reported as
+ * unavailable instead of failing the run.
+ */
+typedef struct CounterSet CounterSet;
+
+typedef struct CounterValues
+{
+    int available[COUNTER_KIND_COUNT];
+    double values[COUNTER_KIND_COUNT];
+} CounterValues;
+
+CounterSet *OpenCounters(int numThreads);
+
+void StartCounters(CounterSet *counters);
+
+void StopCounters(CounterSet *counters);
+
+// Totals over all team threads since OpenCounters, divided by numCalls and
+// scaled for multiplexing.
+CounterValues ReadCounters(CounterSet *counters, int numCalls);
+
+void CloseCounters(CounterSet *counters);
+
+const char *GetCounterName(CounterKind kind);
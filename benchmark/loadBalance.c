@@ -0,0 +1,68 @@
+#include "loadBalance.h"
+#include "omp.h"
+#include "string.h"
+
+#define CACHE_LINE_SIZE 64
+#define MAX_LOAD_BALANCE_THREADS 256
+
+typedef struct ThreadLoad
+{
+    long long iterations;
+    double busyTime;
+    int recorded;
+} __attribute__((aligned(CACHE_LINE_SIZE))) ThreadLoad;
+
+static ThreadLoad threadLoads[MAX_LOAD_BALANCE_THREADS];
+
+void RecordThreadLoad(long long iterations, double busyTime)
+{
+    int threadNum = omp_get_thread_num();
+    if (threadNum >= MAX_LOAD_BALANCE_THREADS)
+    {
+        return;
+    }
+    // Accumulates, so a kernel made of several loops is reported as a whole.
+    threadLoads[threadNum].iterations += iterations;
+    threadLoads[threadNum].busyTime += busyTime;
+    threadLoads[threadNum].recorded = 1;
+}
+
+void ResetThreadLoads()
+{
+    memset(threadLoads, 0, sizeof(threadLoads));
+}
+
+LoadBalance GetLoadBalance()
+{
+    LoadBalance balance = {0};
+    long long totalIterations = 0;
+    long long maxIterations = 0;
+    for (int t = 0; t < MAX_LOAD_BALANCE_THREADS; t++)
+    {
+        if (!threadLoads[t].recorded)
+        {
+            continue;
+        }
+        balance.numThreads++;
+        totalIterations += threadLoads[t].iterations;
+        balance.totalBusyTime += threadLoads[t].busyTime;
+        if (threadLoads[t].iterations > maxIterations)
+        {
+            maxIterations = threadLoads[t].iterations;
+        }
+        if (threadLoads[t].busyTime > balance.maxBusyTime)
+        {
+            balance.maxBusyTime = threadLoads[t].busyTime;
+        }
+    }
+    if (balance.numThreads > 0)
+    {
+        balance.iterationImbalance = totalIterations > 0
+                                         ? (double)maxIterations * balance.numThreads / totalIterations
+                                         : 1;
+        balance.busyImbalance = balance.totalBusyTime > 0
+                                    ? balance.maxBusyTime * balance.numThreads / balance.totalBusyTime
+                                    : 1;
+    }
+    return balance;
+}
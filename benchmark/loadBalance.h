@@ -0,0 +1,54 @@
+#ifndef OPENMP_LOAD_BALANCE_H
+#define OPENMP_LOAD_BALANCE_H
+#endif
+
+/*
+ * Per thread iteration and busy time counters for work-sharing loops,
+ * compiled in with -DLOAD_BALANCE_STATS (CMake option LOAD_BALANCE_STATS)
+ * and expanding to nothing otherwise. A loop is instrumented as
+ *
+ *   #pragma omp parallel
+ *   {
+ *       LOAD_BALANCE_THREAD_BEGIN();
+ *   #pragma omp for nowait
+ *       for (...)
+ *       {
+ *           LOAD_BALANCE_ITERATION();
+ *           ...
+ *       }
+ *       LOAD_BALANCE_THREAD_END();
+ *   }
+ *
+ * so the busy time stops before the closing barrier. Counting is done in
+ * locals and published once per thread into its own cache line.
+ */
+#ifdef LOAD_BALANCE_STATS
+#define LOAD_BALANCE_THREAD_BEGIN()           \
+    long long loadBalanceIterations = 0;      \
+    double loadBalanceStart = omp_get_wtime()
+#define LOAD_BALANCE_ITERATION() loadBalanceIterations++
+#define LOAD_BALANCE_THREAD_END() RecordThreadLoad(loadBalanceIterations, omp_get_wtime() - loadBalanceStart)
+#else
+#define LOAD_BALANCE_THREAD_BEGIN() ((void)0)
+#define LOAD_BALANCE_ITERATION() ((void)0)
+#define LOAD_BALANCE_THREAD_END() ((void)0)
+#endif
+
+/*
+ * Loads recorded since the last reset. Imbalances are max over mean across
+ * the threads that recorded, busy times are in seconds.
+ */
+typedef struct LoadBalance
+{
+    int numThreads;
+    double iterationImbalance;
+    double busyImbalance;
+    double totalBusyTime;
+    double maxBusyTime;
+} LoadBalance;
+
+void RecordThreadLoad(long long iterations, double busyTime);
+
+void ResetThreadLoads();
+
+LoadBalance GetLoadBalance();
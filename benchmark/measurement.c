@@ -0,0 +1,257 @@
+#include "measurement.h"
+#include "malloc.h"
+#include "math.h"
+#include "stdlib.h"
+#include <time.h>
+
+#ifdef CLOCK_MONOTONIC_RAW
+#define STEADY_CLOCK CLOCK_MONOTONIC_RAW
+#else
+#define STEADY_CLOCK CLOCK_MONOTONIC
+#endif
+
+// Two-sided 95% Student t quantiles for 1..30 degrees of freedom.
+static const double studentT95[] = {
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+
+MeasurementConfig GetDefaultMeasurementConfig()
+{
+    return (MeasurementConfig){
+        .warmupRuns = 2,
+        .minRepetitions = 5,
+        .maxRepetitions = 200,
+        .targetRelativeError = 0.02,
+        .maxTotalTime = 10000};
+}
+
+int GetMaxRepetitions(const MeasurementConfig *config)
+{
+    return config->maxRepetitions > config->minRepetitions ? config->maxRepetitions : config->minRepetitions;
+}
+
+double GetSteadyTimeMs()
+{
+    struct timespec now;
+    clock_gettime(STEADY_CLOCK, &now);
+    return now.tv_sec * 1e3 + now.tv_nsec * 1e-6;
+}
+
+static int compareDoubles(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Linear interpolation between the closest ranks of a sorted sample.
+static double percentile(const double *sorted, int count, double fraction)
+{
+    double rank = fraction * (count - 1);
+    int lower = (int)rank;
+    if (lower + 1 >= count)
+    {
+        return sorted[count - 1];
+    }
+    return sorted[lower] + (rank - lower) * (sorted[lower + 1] - sorted[lower]);
+}
+
+static MeasurementStats summarize(const double *samples, double *sorted, int count)
+{
+    MeasurementStats stats = {0};
+    for (int i = 0; i < count; i++)
+    {
+        sorted[i] = samples[i];
+    }
+    qsort(sorted, count, sizeof(double), compareDoubles);
+
+    stats.repetitions = count;
+    stats.min = sorted[0];
+    stats.max = sorted[count - 1];
+    stats.median = percentile(sorted, count, 0.5);
+    stats.p90 = percentile(sorted, count, 0.9);
+    stats.p99 = percentile(sorted, count, 0.99);
+
+    double q1 = percentile(sorted, count, 0.25);
+    double q3 = percentile(sorted, count, 0.75);
+    double lowerFence = q1 - 3 * (q3 - q1);
+    double upperFence = q3 + 3 * (q3 - q1);
+
+    int kept = 0;
+    double sum = 0;
+    for (int i = 0; i < count; i++)
+    {
+        if (sorted[i] >= lowerFence && sorted[i] <= upperFence)
+        {
+            sum += sorted[i];
+            kept++;
+        }
+    }
+    stats.outliers = count - kept;
+    stats.mean = sum / kept;
+
+    double squares = 0;
+    for (int i = 0; i < count; i++)
+    {
+        if (sorted[i] >= lowerFence && sorted[i] <= upperFence)
+        {
+            squares += (sorted[i] - stats.mean) * (sorted[i] - stats.mean);
+        }
+    }
+    if (kept > 1)
+    {
+        stats.stddev = sqrt(squares / (kept - 1));
+        double t = kept - 1 <= 30 ? studentT95[kept - 2] : 1.96;
+        stats.confidenceHalfWidth = t * stats.stddev / sqrt(kept);
+    }
+    return stats;
+}
+
+MeasurementStats SummarizeSamples(const double *samples, int count)
+{
+    double *sorted = malloc(sizeof(double) * count);
+    MeasurementStats stats = summarize(samples, sorted, count);
+    free(sorted);
+    return stats;
+}
+
+/*
+ * Runs call warmupRuns times untimed, then times it until the confidence
+ * interval is tight enough, maxRepetitions is reached or the time budget is
+ * spent, whichever comes first, but never fewer than minRepetitions times.
+ * hooks may be NULL. If samples is not NULL it receives the raw times of
+ * the timed calls and must hold GetMaxRepetitions(config) values.
+ */
+MeasurementStats MeasureCall(MeasuredCall call, const MeasurementHooks *hooks, void *context,
+                             const MeasurementConfig *config, double *samples)
+{
+    int maxRepetitions = GetMaxRepetitions(config);
+    double *ownSamples = samples == NULL ? malloc(sizeof(double) * maxRepetitions) : NULL;
+    if (samples == NULL)
+    {
+        samples = ownSamples;
+    }
+    double *sorted = malloc(sizeof(double) * maxRepetitions);
+
+    const MeasurementHooks noHooks = {0};
+    if (hooks == NULL)
+    {
+        hooks = &noHooks;
+    }
+
+    for (int i = 0; i < config->warmupRuns; i++)
+    {
+        if (hooks->prepare != NULL)
+        {
+            hooks->prepare(context);
+        }
+        call(context);
+    }
+
+    MeasurementStats stats = {0};
+    double totalTime = 0;
+    int count = 0;
+    while (count < maxRepetitions)
+    {
+        if (hooks->prepare != NULL)
+        {
+            hooks->prepare(context);
+        }
+        if (hooks->start != NULL)
+        {
+            hooks->start(context);
+        }
+        double start = GetSteadyTimeMs();
+        call(context);
+        double end = GetSteadyTimeMs();
+        if (hooks->stop != NULL)
+        {
+            hooks->stop(context);
+        }
+        samples[count++] = end - start;
+        totalTime += end - start;
+
+        if (count < config->minRepetitions)
+        {
+            continue;
+        }
+        stats = summarize(samples, sorted, count);
+        if (stats.confidenceHalfWidth <= config->targetRelativeError * stats.mean || totalTime >= config->maxTotalTime)
+        {
+            break;
+        }
+    }
+    if (count < config->minRepetitions)
+    {
+        stats = summarize(samples, sorted, count);
+    }
+
+    free(ownSamples);
+    free(sorted);
+    return stats;
+}
+
+static int compareRanked(const void *a, const void *b)
+{
+    const double *x = a;
+    const double *y = b;
+    return (x[0] > y[0]) - (x[0] < y[0]);
+}
+
+/*
+ * One-sided Mann-Whitney U test of "current tends to be larger than
+ * baseline", with the normal approximation, tie correction and continuity
+ * correction. Fine for the sample sizes the measurement produces (5 and
+ * up on both sides).
+ */
+double MannWhitneyGreaterPValue(const double *current, int numCurrent, const double *baseline, int numBaseline)
+{
+    int total = numCurrent + numBaseline;
+    // (value, 1 for current / 0 for baseline) pairs ranked together.
+    double *ranked = malloc(sizeof(double) * 2 * total);
+    for (int i = 0; i < numCurrent; i++)
+    {
+        ranked[2 * i] = current[i];
+        ranked[2 * i + 1] = 1;
+    }
+    for (int i = 0; i < numBaseline; i++)
+    {
+        ranked[2 * (numCurrent + i)] = baseline[i];
+        ranked[2 * (numCurrent + i) + 1] = 0;
+    }
+    qsort(ranked, total, 2 * sizeof(double), compareRanked);
+
+    double currentRankSum = 0;
+    double tieTerm = 0;
+    for (int i = 0; i < total;)
+    {
+        int j = i;
+        while (j < total && ranked[2 * j] == ranked[2 * i])
+        {
+            j++;
+        }
+        double rank = (i + 1 + j) / 2.0;
+        for (int k = i; k < j; k++)
+        {
+            if (ranked[2 * k + 1] == 1)
+            {
+                currentRankSum += rank;
+            }
+        }
+        double ties = j - i;
+        tieTerm += ties * ties * ties - ties;
+        i = j;
+    }
+    free(ranked);
+
+    double u = currentRankSum - numCurrent * (numCurrent + 1) / 2.0;
+    double mean = numCurrent * (double)numBaseline / 2;
+    double variance = numCurrent * (double)numBaseline / 12 * ((total + 1) - tieTerm / ((double)total * (total - 1)));
+    if (variance <= 0)
+    {
+        return u > mean ? 0 : 1;
+    }
+    double z = (u - mean - 0.5) / sqrt(variance);
+    return 0.5 * erfc(z / sqrt(2));
+}
@@ -0,0 +1,64 @@
+#ifndef OPENMP_MEASUREMENT_H
+#define OPENMP_MEASUREMENT_H
+#endif
+
+typedef struct MeasurementConfig
+{
+    int warmupRuns;
+    int minRepetitions;
+    int maxRepetitions;
+    // Stop once the 95% confidence interval of the mean is within
+    // targetRelativeError of the mean.
+    double targetRelativeError;
+    // Upper bound on the timed calls of one measurement, in milliseconds.
+    double maxTotalTime;
+} MeasurementConfig;
+
+/*
+ * Summary of one measurement, all times in milliseconds. Samples outside
+ * Tukey's far-out fences (3 IQR beyond the quartiles) are counted in
+ * outliers and excluded from mean, stddev and the confidence interval; the
+ * order statistics use every sample.
+ */
+typedef struct MeasurementStats
+{
+    int repetitions;
+    int outliers;
+    double min;
+    double median;
+    double mean;
+    double p90;
+    double p99;
+    double max;
+    double stddev;
+    double confidenceHalfWidth;
+} MeasurementStats;
+
+typedef void (*MeasuredCall)(void *context);
+
+/*
+ * Optional callbacks around every timed call, all of them untimed: prepare
+ * also runs before warmup calls, start and stop bracket only the timed
+ * calls and run just outside the clock reads.
+ */
+typedef struct MeasurementHooks
+{
+    MeasuredCall prepare;
+    MeasuredCall start;
+    MeasuredCall stop;
+} MeasurementHooks;
+
+MeasurementConfig GetDefaultMeasurementConfig();
+
+double GetSteadyTimeMs();
+
+// Upper bound on the timed calls of one measurement.
+int GetMaxRepetitions(const MeasurementConfig *config);
+
+// Statistics of count samples timed elsewhere, count > 0.
+MeasurementStats SummarizeSamples(const double *samples, int count);
+
+MeasurementStats MeasureCall(MeasuredCall call, const MeasurementHooks *hooks, void *context,
+                             const MeasurementConfig *config, double *samples);
+
+double MannWhitneyGreaterPValue(const double *current, int numCurrent, const double *baseline, int numBaseline);
@@ -0,0 +1,38 @@
+#define _GNU_SOURCE
+#include "profiler.h"
+#include "../ompt/omptProfiler.h"
+#include <dlfcn.h>
+#include <stddef.h>
+
+typedef int (*ControlTool)(int command, int modifier, void *arg);
+
+static ControlTool controlTool;
+static int resolved = 0;
+
+static void sendCommand(int command, void *arg)
+{
+    if (!resolved)
+    {
+        controlTool = (ControlTool)dlsym(RTLD_DEFAULT, "omp_control_tool");
+        resolved = 1;
+    }
+    if (controlTool != NULL)
+    {
+        controlTool(command, 0, arg);
+    }
+}
+
+void BeginProfilerVariant(const char *name)
+{
+    sendCommand(OMPT_PROFILER_VARIANT, (void *)name);
+}
+
+void ResumeProfiler()
+{
+    sendCommand(OMPT_PROFILER_START, NULL);
+}
+
+void PauseProfiler()
+{
+    sendCommand(OMPT_PROFILER_PAUSE, NULL);
+}
@@ -0,0 +1,15 @@
+#ifndef OPENMP_PROFILER_H
+#define OPENMP_PROFILER_H
+#endif
+
+/*
+ * Forwarding to an OMPT tool such as ompt/omptProfiler.c through
+ * omp_control_tool. The entry point is looked up at run time because
+ * libgomp does not provide it; without it, or without a tool, these do
+ * nothing.
+ */
+void BeginProfilerVariant(const char *name);
+
+void ResumeProfiler();
+
+void PauseProfiler();
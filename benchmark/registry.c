@@ -0,0 +1,633 @@
+#include "registry.h"
+#include "counters.h"
+#include "roofline.h"
+#include "affinity.h"
+#include "profiler.h"
+#include "loadBalance.h"
+#include "baseline.h"
+#include "resultSink.h"
+#include "caches.h"
+#include "../datatypes/hugePages.h"
+#include "limits.h"
+#include "malloc.h"
+#include "math.h"
+#include "omp.h"
+#include "stdio.h"
+#include "string.h"
+#include <fnmatch.h>
+#include <time.h>
+
+#define MAX_GROUPS 64
+#define MAX_BENCHMARKS 256
+#define MAX_NAME_LENGTH 256
+
+static BenchmarkGroup groups[MAX_GROUPS];
+static int numGroups = 0;
+static Benchmark benchmarks[MAX_BENCHMARKS];
+static int numBenchmarks = 0;
+
+// Kernel results are stored here so the compiler cannot drop the calls.
+static volatile double resultSink;
+// Leading pages column of every row while page kinds are swept.
+static const char *pagesColumn;
+
+// What a run shares between its measurements.
+typedef struct RunState
+{
+    RooflinePeaks peaks;
+    BaselineWriter *baselineWriter;
+    Baseline *baseline;
+    int numRegressions;
+    ResultSink *sink;
+} RunState;
+
+const BenchmarkGroup *RegisterBenchmarkGroup(BenchmarkGroup group)
+{
+    if (numGroups == MAX_GROUPS)
+    {
+        fprintf(stderr, "Too many benchmark groups, %s is not registered\n", group.name);
+        return NULL;
+    }
+    groups[numGroups] = group;
+    return &groups[numGroups++];
+}
+
+void RegisterBenchmark(const BenchmarkGroup *group, const char *method, double (*run)(void *input), int isParallel)
+{
+    if (group == NULL)
+    {
+        return;
+    }
+    if (numBenchmarks == MAX_BENCHMARKS)
+    {
+        fprintf(stderr, "Too many benchmarks, %s/%s is not registered\n", group->name, method);
+        return;
+    }
+    benchmarks[numBenchmarks++] = (Benchmark){.group = group, .method = method, .run = run, .isParallel = isParallel};
+}
+
+int GetBenchmarkCount()
+{
+    return numBenchmarks;
+}
+
+const Benchmark *GetBenchmark(int index)
+{
+    return &benchmarks[index];
+}
+
+/*
+ * filter is a comma separated list of shell patterns. A pattern selects a
+ * benchmark if it matches either its group name or "group/method"; a NULL
+ * or empty filter selects everything.
+ */
+int MatchesBenchmarkFilter(const Benchmark *benchmark, const char *filter)
+{
+    if (filter == NULL || *filter == '\0')
+    {
+        return 1;
+    }
+    char fullName[MAX_NAME_LENGTH];
+    snprintf(fullName, sizeof(fullName), "%s/%s", benchmark->group->name, benchmark->method);
+
+    char pattern[MAX_NAME_LENGTH];
+    const char *start = filter;
+    while (*start != '\0')
+    {
+        const char *end = strchr(start, ',');
+        size_t length = end == NULL ? strlen(start) : (size_t)(end - start);
+        if (length >= sizeof(pattern))
+        {
+            length = sizeof(pattern) - 1;
+        }
+        memcpy(pattern, start, length);
+        pattern[length] = '\0';
+        if (length > 0 &&
+            (fnmatch(pattern, fullName, 0) == 0 || fnmatch(pattern, benchmark->group->name, 0) == 0))
+        {
+            return 1;
+        }
+        if (end == NULL)
+        {
+            break;
+        }
+        start = end + 1;
+    }
+    return 0;
+}
+
+typedef struct BenchmarkCall
+{
+    const Benchmark *benchmark;
+    void *input;
+    CounterSet *counters;
+    // Load balance of the timed calls, only filled with LOAD_BALANCE_STATS.
+    double callStart;
+    int balancedCalls;
+    double iterationImbalance;
+    double busyImbalance;
+    double busyTime;
+    double threadTime;
+    // Process CPU and wall time of the timed calls, with recordCpuTime.
+    int measureCpuTime;
+    double cpuStart;
+    double wallStart;
+    double cpuTime;
+    double wallTime;
+} BenchmarkCall;
+
+// CPU time of all threads of the process, spinning and sleeping included.
+static double getProcessCpuTimeMs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+    return now.tv_sec * 1e3 + now.tv_nsec * 1e-6;
+}
+
+/*
+ * Threads the runtime gives a region right now. With OMP_DYNAMIC it may be
+ * fewer than requested; sampled right after a measurement, like the
+ * placement, so it matches the measured regions unless the load changed.
+ */
+static int getTeamSize()
+{
+    int teamSize = 0;
+#pragma omp parallel shared(teamSize) default(none)
+    {
+#pragma omp single
+        teamSize = omp_get_num_threads();
+    }
+    return teamSize;
+}
+
+static void callBenchmark(void *context)
+{
+    BenchmarkCall *call = context;
+    resultSink = call->benchmark->run(call->input);
+}
+
+static void resetBenchmarkInput(void *context)
+{
+    BenchmarkCall *call = context;
+    call->benchmark->group->reset(call->input);
+}
+
+// Counters and an attached OMPT tool only see the timed calls.
+static void startMeasuredCall(void *context)
+{
+    BenchmarkCall *call = context;
+    if (call->counters != NULL)
+    {
+        StartCounters(call->counters);
+    }
+    ResumeProfiler();
+#ifdef LOAD_BALANCE_STATS
+    ResetThreadLoads();
+    call->callStart = omp_get_wtime();
+#endif
+    if (call->measureCpuTime)
+    {
+        call->wallStart = GetSteadyTimeMs();
+        call->cpuStart = getProcessCpuTimeMs();
+    }
+}
+
+static void stopMeasuredCall(void *context)
+{
+    BenchmarkCall *call = context;
+    if (call->measureCpuTime)
+    {
+        call->cpuTime += getProcessCpuTimeMs() - call->cpuStart;
+        call->wallTime += GetSteadyTimeMs() - call->wallStart;
+    }
+#ifdef LOAD_BALANCE_STATS
+    double elapsed = omp_get_wtime() - call->callStart;
+    LoadBalance balance = GetLoadBalance();
+    if (balance.numThreads > 0)
+    {
+        call->balancedCalls++;
+        call->iterationImbalance += balance.iterationImbalance;
+        call->busyImbalance += balance.busyImbalance;
+        call->busyTime += balance.totalBusyTime;
+        call->threadTime += balance.numThreads * elapsed;
+    }
+#endif
+    PauseProfiler();
+    if (call->counters != NULL)
+    {
+        StopCounters(call->counters);
+    }
+}
+
+/*
+ * Throughput of the median call and its share of the roofline: the
+ * attainable rate is min(peak ops, intensity * peak bandwidth) for kernels
+ * that compute, the peak bandwidth for pure data movement. Integer
+ * multiply-adds are held against the integer ceiling.
+ */
+static void setThroughput(const BenchmarkWork *work, double medianMs, const RooflinePeaks *peaks,
+                          ResultRecord *record)
+{
+    double seconds = medianMs / 1e3;
+    record->bytes = work->bytes;
+    record->operations = work->operations;
+    record->gigabytesPerSecond = work->bytes / seconds / 1e9;
+    record->gigaopsPerSecond = work->operations / seconds / 1e9;
+    if (peaks->numThreads == 0)
+    {
+        // Without --roofline percent_of_peak stays NA.
+        return;
+    }
+    if (work->operations > 0)
+    {
+        double attainable = work->integerOperations ? peaks->integerOperations : peaks->operations;
+        if (work->bytes > 0 && work->operations / work->bytes * peaks->bandwidth < attainable)
+        {
+            attainable = work->operations / work->bytes * peaks->bandwidth;
+        }
+        record->percentOfPeak = 100 * record->gigaopsPerSecond / attainable;
+    }
+    else
+    {
+        record->percentOfPeak = 100 * record->gigabytesPerSecond / peaks->bandwidth;
+    }
+}
+
+/*
+ * A regression is a slowdown of the median beyond the threshold that the
+ * one-sided Mann-Whitney test also finds significant; "faster" is the
+ * mirror image. Regressions are repeated on stderr.
+ */
+static void compareWithBaseline(const Benchmark *benchmark, int size, int numThreads, const double *samples,
+                                const MeasurementStats *stats, const BenchmarkConfig *config, RunState *state,
+                                ResultRecord *record)
+{
+    const BaselineResult *result =
+        FindBaselineResult(state->baseline, pagesColumn, benchmark->group->name, benchmark->method, size, numThreads);
+    if (result == NULL)
+    {
+        strcpy(record->verdict, "missing");
+        return;
+    }
+    double change = stats->median / result->median - 1;
+    double slowerPValue = MannWhitneyGreaterPValue(samples, stats->repetitions, result->samples, result->numSamples);
+    double fasterPValue = MannWhitneyGreaterPValue(result->samples, result->numSamples, samples, stats->repetitions);
+    const char *verdict = "same";
+    if (slowerPValue < config->significance && change > config->regressionThreshold)
+    {
+        verdict = "regression";
+        state->numRegressions++;
+        fprintf(stderr, "Regression: %s%s%s/%s size %d, %d threads: median %.6f ms -> %.6f ms (%+.1f%%, p = %.2g)\n",
+                pagesColumn != NULL ? pagesColumn : "", pagesColumn != NULL ? " pages " : "", benchmark->group->name,
+                benchmark->method, size, numThreads, result->median, stats->median, 100 * change, slowerPValue);
+    }
+    else if (fasterPValue < config->significance && -change > config->regressionThreshold)
+    {
+        verdict = "faster";
+    }
+    record->baselineMedian = result->median;
+    record->change = change;
+    record->pValue = slowerPValue < fasterPValue ? slowerPValue : fasterPValue;
+    strcpy(record->verdict, verdict);
+}
+
+/*
+ * sizePerThread is the problem size of one thread. weakReference, in weak
+ * scaling runs, holds the method's median at the first thread count (NaN
+ * until that has run); the efficiency is that median over this one.
+ */
+static void runBenchmark(const Benchmark *benchmark, void *input, int size, int numThreads, int sizePerThread,
+                         double *weakReference, const BenchmarkConfig *config, RunState *state)
+{
+    BenchmarkCall call = {.benchmark = benchmark, .input = input, .measureCpuTime = config->recordCpuTime};
+    MeasurementHooks hooks = {.start = startMeasuredCall, .stop = stopMeasuredCall};
+    if (benchmark->group->reset != NULL)
+    {
+        hooks.prepare = resetBenchmarkInput;
+    }
+    if (config->collectCounters)
+    {
+        call.counters = OpenCounters(numThreads);
+    }
+
+    char variant[MAX_NAME_LENGTH];
+    snprintf(variant, sizeof(variant), "%s/%s/%d/%d", benchmark->group->name, benchmark->method, size, numThreads);
+    BeginProfilerVariant(variant);
+    double *samples = malloc(sizeof(double) * GetMaxRepetitions(&config->measurement));
+    MeasurementStats stats = MeasureCall(callBenchmark, &hooks, &call, &config->measurement, samples);
+
+    // Unset optional values stay NaN and are written as NA.
+    ResultRecord result;
+    ResultRecord *record = &result;
+    for (int i = 0; i < MAX_RESULT_COUNTERS; i++)
+    {
+        record->counters[i] = NAN;
+    }
+    record->bytes = record->operations = record->gigabytesPerSecond = record->gigaopsPerSecond =
+        record->percentOfPeak = record->weakEfficiency = record->cpuTime = record->busyThreads = NAN;
+    record->iterationImbalance = record->busyImbalance = record->parallelEfficiency = NAN;
+    record->baselineMedian = record->change = record->pValue = NAN;
+    snprintf(record->pages, sizeof(record->pages), "%s", pagesColumn != NULL ? pagesColumn : "");
+    snprintf(record->group, sizeof(record->group), "%s", benchmark->group->name);
+    snprintf(record->method, sizeof(record->method), "%s", benchmark->method);
+    record->size = size;
+    record->numThreads = numThreads;
+    record->sizePerThread = sizePerThread;
+    record->teamSize = numThreads;
+    snprintf(record->workingSet, sizeof(record->workingSet), "NA");
+    record->repetitions = stats.repetitions;
+    record->outliers = stats.outliers;
+    record->min = stats.min;
+    record->median = stats.median;
+    record->mean = stats.mean;
+    record->p90 = stats.p90;
+    record->p99 = stats.p99;
+    record->max = stats.max;
+    record->stddev = stats.stddev;
+    record->confidenceHalfWidth = stats.confidenceHalfWidth;
+    if (benchmark->group->work != NULL)
+    {
+        BenchmarkWork work = benchmark->group->work(input);
+        setThroughput(&work, stats.median, &state->peaks, record);
+        // Bytes moved by one call, as the best available working set size.
+        snprintf(record->workingSet, sizeof(record->workingSet), "%s", GetWorkingSetLevel(work.bytes, numThreads));
+    }
+    if (weakReference != NULL)
+    {
+        if (isnan(*weakReference))
+        {
+            *weakReference = stats.median;
+        }
+        record->weakEfficiency = *weakReference / stats.median;
+    }
+    if (call.measureCpuTime && stats.repetitions > 0)
+    {
+        // Per timed call, summed over the threads; busy threads is how
+        // many were on a CPU on average while a call ran.
+        record->cpuTime = call.cpuTime / stats.repetitions;
+        record->busyThreads = call.wallTime > 0 ? call.cpuTime / call.wallTime : NAN;
+        record->teamSize = getTeamSize();
+    }
+    if (config->recordPlacement)
+    {
+        GetThreadPlacement(numThreads, record->cpus, sizeof(record->cpus));
+    }
+#ifdef LOAD_BALANCE_STATS
+    // Mean imbalance of the timed calls; efficiency is the busy share of
+    // the team's thread time, fork and join included.
+    if (call.balancedCalls > 0)
+    {
+        record->iterationImbalance = call.iterationImbalance / call.balancedCalls;
+        record->busyImbalance = call.busyImbalance / call.balancedCalls;
+        record->parallelEfficiency = call.busyTime / call.threadTime;
+    }
+#endif
+    if (state->baseline != NULL)
+    {
+        compareWithBaseline(benchmark, size, numThreads, samples, &stats, config, state, record);
+    }
+    if (state->baselineWriter != NULL)
+    {
+        WriteBaselineResult(state->baselineWriter, pagesColumn, benchmark->group->name, benchmark->method, size,
+                            numThreads, stats.median, samples, stats.repetitions);
+    }
+    free(samples);
+    if (call.counters != NULL)
+    {
+        // Counts are per timed call, summed over the team's threads.
+        CounterValues counters = ReadCounters(call.counters, stats.repetitions);
+        for (CounterKind kind = 0; kind < COUNTER_KIND_COUNT && kind < MAX_RESULT_COUNTERS; kind++)
+        {
+            if (counters.available[kind])
+            {
+                record->counters[kind] = counters.values[kind];
+            }
+        }
+        CloseCounters(call.counters);
+    }
+    PushResult(state->sink, record);
+}
+
+/*
+ * Builds the input of one configuration. Under --pages it is torn down
+ * again, and NULL returned, if its arrays did not get the requested kind,
+ * because they fell back or are too small for huge pages: its rows and
+ * baseline entries would carry the wrong pages label.
+ */
+static void *setupInput(const BenchmarkGroup *group, int size)
+{
+    ResetGrantedPageKind();
+    void *input = group->setup(size, group->parameters);
+    if (pagesColumn != NULL && GetGrantedPageKind() != GetPageKind())
+    {
+        fprintf(stderr, "%s: size %d got %s instead of %s pages, skipped\n", group->name, size,
+                GetPageKindName(GetGrantedPageKind()), pagesColumn);
+        group->teardown(input);
+        return NULL;
+    }
+    return input;
+}
+
+/*
+ * Weak scaling: the parallel variants get sizePerThread elements per
+ * thread, so every thread count needs its own input.
+ */
+static void runWeakScaling(const BenchmarkGroup *group, const Benchmark **selected, int numSelected,
+                           int sizePerThread, const BenchmarkConfig *config, RunState *state)
+{
+    double weakReferences[MAX_BENCHMARKS];
+    for (int b = 0; b < numSelected; b++)
+    {
+        weakReferences[b] = NAN;
+    }
+    for (int t = 0; t < config->numThreadCounts; t++)
+    {
+        int numThreads = config->threadCounts[t];
+        if ((long long)sizePerThread * numThreads > INT_MAX)
+        {
+            fprintf(stderr, "%s: size %d with %d threads does not fit an int, skipped\n", group->name,
+                    sizePerThread, numThreads);
+            continue;
+        }
+        void *input = setupInput(group, sizePerThread * numThreads);
+        if (input == NULL)
+        {
+            continue;
+        }
+        omp_set_num_threads(numThreads);
+        for (int b = 0; b < numSelected; b++)
+        {
+            if (selected[b]->isParallel)
+            {
+                runBenchmark(selected[b], input, sizePerThread * numThreads, numThreads, sizePerThread,
+                             &weakReferences[b], config, state);
+            }
+        }
+        group->teardown(input);
+        // Rows of finished configurations are written before the next one
+        // is measured, so a long sweep that is killed keeps them.
+        FlushResults(state->sink);
+    }
+}
+
+static void runGroup(const BenchmarkGroup *group, const BenchmarkConfig *config, RunState *state)
+{
+    const Benchmark *selected[MAX_BENCHMARKS];
+    int numSelected = 0;
+    for (int i = 0; i < numBenchmarks; i++)
+    {
+        if (benchmarks[i].group == group && MatchesBenchmarkFilter(&benchmarks[i], config->filter))
+        {
+            selected[numSelected++] = &benchmarks[i];
+        }
+    }
+    if (numSelected == 0)
+    {
+        return;
+    }
+
+    const int numSizes = config->numSizes > 0 ? config->numSizes : group->numDefaultSizes;
+    const int *sizes = config->numSizes > 0 ? config->sizes : group->defaultSizes;
+    for (int s = 0; s < numSizes; s++)
+    {
+        void *input = setupInput(group, sizes[s]);
+        if (input != NULL)
+        {
+            // Serial variants are the baseline of every size and run once,
+            // independently of the thread counts being swept.
+            omp_set_num_threads(1);
+            for (int b = 0; b < numSelected; b++)
+            {
+                if (!selected[b]->isParallel)
+                {
+                    runBenchmark(selected[b], input, sizes[s], 1, sizes[s], NULL, config, state);
+                }
+            }
+            for (int t = 0; t < config->numThreadCounts && !config->weakScaling; t++)
+            {
+                omp_set_num_threads(config->threadCounts[t]);
+                for (int b = 0; b < numSelected; b++)
+                {
+                    if (selected[b]->isParallel)
+                    {
+                        runBenchmark(selected[b], input, sizes[s], config->threadCounts[t],
+                                     sizes[s] / config->threadCounts[t], NULL, config, state);
+                    }
+                }
+            }
+            group->teardown(input);
+            FlushResults(state->sink);
+        }
+        if (config->weakScaling)
+        {
+            runWeakScaling(group, selected, numSelected, sizes[s], config, state);
+        }
+    }
+}
+
+/*
+ * Returns 0 on success, 1 if the output or a baseline cannot be used or if
+ * the comparison with a baseline finds a regression.
+ */
+int RunBenchmarks(const BenchmarkConfig *config)
+{
+    RunState state = {0};
+    if (config->comparePath != NULL)
+    {
+        state.baseline = LoadBaseline(config->comparePath);
+        if (state.baseline == NULL)
+        {
+            return 1;
+        }
+        char machine[512];
+        GetMachineTag(machine, sizeof(machine));
+        if (state.baseline->machine == NULL || strcmp(state.baseline->machine, machine) != 0)
+        {
+            fprintf(stderr, "Warning: baseline was recorded on \"%s\", this is \"%s\"\n",
+                    state.baseline->machine != NULL ? state.baseline->machine : "an unknown machine", machine);
+        }
+    }
+    if (config->baselinePath != NULL)
+    {
+        state.baselineWriter = OpenBaselineWriter(config->baselinePath);
+        if (state.baselineWriter == NULL)
+        {
+            return 1;
+        }
+    }
+    unsigned columns = 0;
+    if (config->numPageKinds > 0)
+    {
+        columns |= RESULT_PAGES;
+    }
+    if (config->recordPlacement)
+    {
+        columns |= RESULT_PLACEMENT;
+    }
+#ifdef LOAD_BALANCE_STATS
+    columns |= RESULT_LOAD_BALANCE;
+#endif
+    if (state.baseline != NULL)
+    {
+        columns |= RESULT_COMPARISON;
+    }
+    if (config->collectCounters)
+    {
+        columns |= RESULT_COUNTERS;
+    }
+    if (config->scalingColumns)
+    {
+        columns |= RESULT_SCALING;
+    }
+    if (config->recordCpuTime)
+    {
+        columns |= RESULT_CPU_TIME;
+    }
+    state.sink = OpenResultSink(config->outPath, config->binaryOutput ? RESULT_BINARY : RESULT_CSV, columns);
+    if (state.sink == NULL)
+    {
+        return 1;
+    }
+    // Ceilings of the whole machine, so every thread count is compared to
+    // the same roof.
+    if (config->measureRoofline)
+    {
+        state.peaks = GetRooflinePeaks(omp_get_num_procs());
+        fprintf(stderr, "Roofline with %d threads: %.2f GB/s, %.2f Gop/s FMA, %.2f Gop/s integer\n",
+                state.peaks.numThreads, state.peaks.bandwidth, state.peaks.operations, state.peaks.integerOperations);
+    }
+
+    if (config->numPageKinds == 0)
+    {
+        for (int g = 0; g < numGroups; g++)
+        {
+            runGroup(&groups[g], config, &state);
+        }
+    }
+    // Inputs are rebuilt per group and size, so every kind gets fresh pages.
+    for (int k = 0; k < config->numPageKinds; k++)
+    {
+        SetPageKind(config->pageKinds[k]);
+        pagesColumn = GetPageKindName(config->pageKinds[k]);
+        for (int g = 0; g < numGroups; g++)
+        {
+            runGroup(&groups[g], config, &state);
+        }
+    }
+    pagesColumn = NULL;
+    int failed = CloseResultSink(state.sink);
+    if (state.baselineWriter != NULL)
+    {
+        CloseBaselineWriter(state.baselineWriter);
+    }
+    if (state.baseline != NULL)
+    {
+        FreeBaseline(state.baseline);
+        if (state.numRegressions > 0)
+        {
+            fprintf(stderr, "%d significant regression(s) against %s\n", state.numRegressions, config->comparePath);
+            return 1;
+        }
+    }
+    return failed;
+}
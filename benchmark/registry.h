@@ -0,0 +1,117 @@
+#ifndef OPENMP_REGISTRY_H
+#define OPENMP_REGISTRY_H
+#endif
+
+#include "measurement.h"
+
+#define MAX_DEFAULT_SIZES 8
+#define MAX_SIZES 256
+#define MAX_THREAD_COUNTS 256
+#define MAX_PAGE_KINDS 8
+
+/*
+ * Logical work of one call: bytes the kernel has to move to or from memory
+ * and the operations it performs, in whatever unit is natural for the
+ * kernel (flops, comparisons, increments). Both are counted once per
+ * element the way STREAM does, without cache line or write allocate
+ * effects.
+ */
+typedef struct BenchmarkWork
+{
+    double bytes;
+    double operations;
+    // The operations are integer multiply-adds and are compared with the
+    // integer ceiling rather than the double precision FMA one.
+    int integerOperations;
+} BenchmarkWork;
+
+/*
+ * A group owns the input of its kernels: setup builds it for one size,
+ * reset (optional) restores it before every timed call for kernels that
+ * modify their input, teardown releases it. parameters is passed to setup
+ * unchanged and lets one setup serve several groups. work (optional)
+ * describes one call on an input and enables the throughput columns.
+ */
+typedef struct BenchmarkGroup
+{
+    const char *name;
+    void *(*setup)(int size, const void *parameters);
+    void (*reset)(void *input);
+    void (*teardown)(void *input);
+    BenchmarkWork (*work)(const void *input);
+    const void *parameters;
+    int numDefaultSizes;
+    int defaultSizes[MAX_DEFAULT_SIZES];
+} BenchmarkGroup;
+
+/*
+ * One kernel variant. run performs exactly one timed call and returns the
+ * kernel result; serial variants are only run with one thread.
+ */
+typedef struct Benchmark
+{
+    const BenchmarkGroup *group;
+    const char *method;
+    double (*run)(void *input);
+    int isParallel;
+} Benchmark;
+
+typedef struct BenchmarkConfig
+{
+    const char *filter;
+    int numSizes;
+    int sizes[MAX_SIZES];
+    // Sizes are per thread: every thread count t runs size * t, and the
+    // serial variants run size.
+    int weakScaling;
+    // Adds the size per thread, working set level and weak scaling
+    // efficiency columns; set by --weak-scaling and --size-sweep.
+    int scalingColumns;
+    int numThreadCounts;
+    int threadCounts[MAX_THREAD_COUNTS];
+    MeasurementConfig measurement;
+    // Adds perf_event hardware counter columns to the output.
+    int collectCounters;
+    // Adds the CPU of every team thread as a cpus column.
+    int recordPlacement;
+    // Measures the roofline ceilings first and fills percent_of_peak.
+    int measureRoofline;
+    // Adds the process CPU time of the timed calls as cpu_ms and
+    // busy_threads columns, and the team size the runtime granted.
+    int recordCpuTime;
+    // Re-runs the selection under every OMP_PROC_BIND and OMP_PLACES setting.
+    int sweepAffinity;
+    // Re-runs the selection under every OMP_WAIT_POLICY, spin and
+    // OMP_DYNAMIC setting (see waitPolicy.h).
+    int sweepWaitPolicy;
+    // PageKind values (datatypes/hugePages.h) to repeat the run with; none
+    // keeps the current kind and omits the pages column.
+    int numPageKinds;
+    int pageKinds[MAX_PAGE_KINDS];
+    // Baseline JSON to write, and to compare against (see baseline.h).
+    const char *baselinePath;
+    const char *comparePath;
+    // A slowdown of the median above regressionThreshold (relative) with a
+    // Mann-Whitney p-value below significance fails the comparison.
+    double regressionThreshold;
+    double significance;
+    const char *outPath;
+    // Writes the columnar binary format of resultSink.h instead of CSV.
+    int binaryOutput;
+    // Converts this binary result file to CSV in outPath instead of running.
+    const char *convertPath;
+    // Serves kernel requests on this socket (service.h) instead of running.
+    const char *servePath;
+} BenchmarkConfig;
+
+const BenchmarkGroup *RegisterBenchmarkGroup(BenchmarkGroup group);
+
+void RegisterBenchmark(const BenchmarkGroup *group, const char *method, double (*run)(void *input), int isParallel);
+
+int GetBenchmarkCount();
+
+const Benchmark *GetBenchmark(int index);
+
+int MatchesBenchmarkFilter(const Benchmark *benchmark, const char *filter);
+
+int RunBenchmarks(const BenchmarkConfig *config);
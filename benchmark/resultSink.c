@@ -0,0 +1,647 @@
+#include "resultSink.h"
+#include "counters.h"
+#include "malloc.h"
+#include "math.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define RING_CAPACITY 256
+#define MAX_RESULT_COLUMNS 64
+#define MAX_FORMAT_LENGTH 16
+#define ENCODING_PLAIN 0
+#define ENCODING_CONSTANT 1
+
+static const char magic[8] = {'O', 'M', 'P', 'R', 'E', 'S', '0', '1'};
+
+typedef enum ColumnType
+{
+    COLUMN_INT,
+    COLUMN_DOUBLE,
+    COLUMN_TEXT
+} ColumnType;
+
+typedef struct ResultColumn
+{
+    const char *name;
+    ColumnType type;
+    const char *format;
+    size_t offset;
+} ResultColumn;
+
+struct ResultSink
+{
+    FILE *file;
+    ResultFormat format;
+    int numColumns;
+    ResultColumn columns[MAX_RESULT_COLUMNS];
+    ResultRecord *ring;
+    // Rows [head, head + count) modulo RING_CAPACITY are waiting; only the
+    // producer appends and only the writer advances head.
+    int head;
+    int count;
+    int closing;
+    // Set by FlushResults, makes the writer take the rows waiting so far.
+    int flushing;
+    int failed;
+    pthread_mutex_t lock;
+    pthread_cond_t wakeWriter;
+    pthread_cond_t spaceFree;
+    // Signalled whenever the writer has emptied the buffer.
+    pthread_cond_t drained;
+    pthread_t writer;
+};
+
+static void addColumn(ResultSink *sink, const char *name, ColumnType type, const char *format, size_t offset)
+{
+    sink->columns[sink->numColumns++] = (ResultColumn){.name = name, .type = type, .format = format, .offset = offset};
+}
+
+#define INT_COLUMN(name, field) addColumn(sink, name, COLUMN_INT, "%d", offsetof(ResultRecord, field))
+#define DOUBLE_COLUMN(name, format, field) addColumn(sink, name, COLUMN_DOUBLE, format, offsetof(ResultRecord, field))
+#define TEXT_COLUMN(name, field) addColumn(sink, name, COLUMN_TEXT, "%s", offsetof(ResultRecord, field))
+
+static void addColumns(ResultSink *sink, unsigned columns)
+{
+    if (columns & RESULT_PAGES)
+    {
+        TEXT_COLUMN("pages", pages);
+    }
+    TEXT_COLUMN("group", group);
+    TEXT_COLUMN("method", method);
+    INT_COLUMN("size", size);
+    INT_COLUMN("num_threads", numThreads);
+    INT_COLUMN("repetitions", repetitions);
+    INT_COLUMN("outliers", outliers);
+    DOUBLE_COLUMN("min", "%.9f", min);
+    DOUBLE_COLUMN("median", "%.9f", median);
+    DOUBLE_COLUMN("mean", "%.9f", mean);
+    DOUBLE_COLUMN("p90", "%.9f", p90);
+    DOUBLE_COLUMN("p99", "%.9f", p99);
+    DOUBLE_COLUMN("max", "%.9f", max);
+    DOUBLE_COLUMN("stddev", "%.9f", stddev);
+    DOUBLE_COLUMN("ci95_half_width", "%.9f", confidenceHalfWidth);
+    DOUBLE_COLUMN("bytes", "%.0f", bytes);
+    DOUBLE_COLUMN("operations", "%.0f", operations);
+    DOUBLE_COLUMN("gb_per_s", "%.6f", gigabytesPerSecond);
+    DOUBLE_COLUMN("gop_per_s", "%.6f", gigaopsPerSecond);
+    DOUBLE_COLUMN("percent_of_peak", "%.3f", percentOfPeak);
+    if (columns & RESULT_SCALING)
+    {
+        INT_COLUMN("size_per_thread", sizePerThread);
+        TEXT_COLUMN("working_set", workingSet);
+        DOUBLE_COLUMN("weak_efficiency", "%.4f", weakEfficiency);
+    }
+    if (columns & RESULT_CPU_TIME)
+    {
+        DOUBLE_COLUMN("cpu_ms", "%.9f", cpuTime);
+        DOUBLE_COLUMN("busy_threads", "%.3f", busyThreads);
+        INT_COLUMN("team_size", teamSize);
+    }
+    if (columns & RESULT_PLACEMENT)
+    {
+        TEXT_COLUMN("cpus", cpus);
+    }
+    if (columns & RESULT_LOAD_BALANCE)
+    {
+        DOUBLE_COLUMN("iteration_imbalance", "%.4f", iterationImbalance);
+        DOUBLE_COLUMN("busy_imbalance", "%.4f", busyImbalance);
+        DOUBLE_COLUMN("parallel_efficiency", "%.4f", parallelEfficiency);
+    }
+    if (columns & RESULT_COMPARISON)
+    {
+        DOUBLE_COLUMN("baseline_median", "%.9f", baselineMedian);
+        DOUBLE_COLUMN("change", "%.4f", change);
+        DOUBLE_COLUMN("p_value", "%.3g", pValue);
+        TEXT_COLUMN("verdict", verdict);
+    }
+    if (columns & RESULT_COUNTERS)
+    {
+        for (CounterKind kind = 0; kind < COUNTER_KIND_COUNT && kind < MAX_RESULT_COUNTERS; kind++)
+        {
+            addColumn(sink, GetCounterName(kind), COLUMN_DOUBLE, "%.0f",
+                      offsetof(ResultRecord, counters) + kind * sizeof(double));
+        }
+    }
+}
+
+static void printHeader(const char *const *names, int numColumns, FILE *file)
+{
+    for (int c = 0; c < numColumns; c++)
+    {
+        fprintf(file, c == 0 ? "%s" : ";%s", names[c]);
+    }
+    fprintf(file, "\n");
+}
+
+// CSV cell of one value; only the member matching type is used.
+static void printCell(ColumnType type, const char *format, int32_t integer, double real, const char *text,
+                      FILE *file)
+{
+    switch (type)
+    {
+    case COLUMN_INT:
+        fprintf(file, format, integer);
+        break;
+    case COLUMN_DOUBLE:
+        if (isnan(real))
+        {
+            fprintf(file, "NA");
+        }
+        else
+        {
+            fprintf(file, format, real);
+        }
+        break;
+    case COLUMN_TEXT:
+        fputs(text, file);
+        break;
+    }
+}
+
+static const void *getField(const ResultRecord *record, const ResultColumn *column)
+{
+    return (const char *)record + column->offset;
+}
+
+static void writeCsvRows(ResultSink *sink, int first, int numRows)
+{
+    for (int r = 0; r < numRows; r++)
+    {
+        const ResultRecord *record = &sink->ring[(first + r) % RING_CAPACITY];
+        for (int c = 0; c < sink->numColumns; c++)
+        {
+            const ResultColumn *column = &sink->columns[c];
+            const void *field = getField(record, column);
+            if (c > 0)
+            {
+                fputc(';', sink->file);
+            }
+            printCell(column->type, column->format, column->type == COLUMN_INT ? *(const int *)field : 0,
+                      column->type == COLUMN_DOUBLE ? *(const double *)field : 0, field, sink->file);
+        }
+        fputc('\n', sink->file);
+    }
+}
+
+// Columns with the same value in every row of a block, typically NA
+// counters, sizes and names, store that value once.
+static int isConstantColumn(ResultSink *sink, const ResultColumn *column, const void *values, int first, int numRows)
+{
+    size_t width = column->type == COLUMN_DOUBLE ? sizeof(double) : sizeof(int32_t);
+    for (int r = 1; r < numRows; r++)
+    {
+        if (memcmp((const char *)values + r * width, values, width) != 0 ||
+            (column->type == COLUMN_TEXT && strcmp(getField(&sink->ring[(first + r) % RING_CAPACITY], column),
+                                                   getField(&sink->ring[first], column)) != 0))
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void writeBinaryBlock(ResultSink *sink, int first, int numRows)
+{
+    uint32_t rows = numRows;
+    fwrite(&rows, sizeof(rows), 1, sink->file);
+    void *values = malloc(sizeof(double) * numRows);
+    for (int c = 0; c < sink->numColumns; c++)
+    {
+        const ResultColumn *column = &sink->columns[c];
+        for (int r = 0; r < numRows; r++)
+        {
+            const void *field = getField(&sink->ring[(first + r) % RING_CAPACITY], column);
+            switch (column->type)
+            {
+            case COLUMN_INT:
+                ((int32_t *)values)[r] = *(const int *)field;
+                break;
+            case COLUMN_DOUBLE:
+                ((double *)values)[r] = *(const double *)field;
+                break;
+            case COLUMN_TEXT:
+                ((uint32_t *)values)[r] = strlen(field);
+                break;
+            }
+        }
+        uint8_t encoding = isConstantColumn(sink, column, values, first, numRows) ? ENCODING_CONSTANT : ENCODING_PLAIN;
+        int numStored = encoding == ENCODING_CONSTANT ? 1 : numRows;
+        fwrite(&encoding, 1, 1, sink->file);
+        fwrite(values, column->type == COLUMN_DOUBLE ? sizeof(double) : sizeof(int32_t), numStored, sink->file);
+        if (column->type == COLUMN_TEXT)
+        {
+            for (int r = 0; r < numStored; r++)
+            {
+                fwrite(getField(&sink->ring[(first + r) % RING_CAPACITY], column), 1, ((uint32_t *)values)[r],
+                       sink->file);
+            }
+        }
+    }
+    free(values);
+}
+
+static void *drainResults(void *argument)
+{
+    ResultSink *sink = argument;
+    for (;;)
+    {
+        pthread_mutex_lock(&sink->lock);
+        while (!sink->closing && !sink->flushing && sink->count < RING_CAPACITY / 2)
+        {
+            pthread_cond_wait(&sink->wakeWriter, &sink->lock);
+        }
+        sink->flushing = 0;
+        int first = sink->head;
+        int numRows = sink->count;
+        int closing = sink->closing;
+        pthread_mutex_unlock(&sink->lock);
+
+        if (numRows == 0 && closing)
+        {
+            break;
+        }
+        if (sink->format == RESULT_CSV)
+        {
+            writeCsvRows(sink, first, numRows);
+        }
+        else
+        {
+            writeBinaryBlock(sink, first, numRows);
+        }
+        // Written rows survive the process being killed later on.
+        fflush(sink->file);
+
+        pthread_mutex_lock(&sink->lock);
+        sink->head = (sink->head + numRows) % RING_CAPACITY;
+        sink->count -= numRows;
+        pthread_cond_signal(&sink->spaceFree);
+        if (sink->count == 0)
+        {
+            pthread_cond_broadcast(&sink->drained);
+        }
+        pthread_mutex_unlock(&sink->lock);
+    }
+    return NULL;
+}
+
+static int writeBinaryHeader(ResultSink *sink)
+{
+    uint32_t numColumns = sink->numColumns;
+    fwrite(magic, sizeof(magic), 1, sink->file);
+    fwrite(&numColumns, sizeof(numColumns), 1, sink->file);
+    for (int c = 0; c < sink->numColumns; c++)
+    {
+        const ResultColumn *column = &sink->columns[c];
+        uint8_t type = column->type;
+        uint8_t nameLength = strlen(column->name);
+        uint8_t formatLength = strlen(column->format);
+        fwrite(&type, 1, 1, sink->file);
+        fwrite(&nameLength, 1, 1, sink->file);
+        fwrite(column->name, 1, nameLength, sink->file);
+        fwrite(&formatLength, 1, 1, sink->file);
+        fwrite(column->format, 1, formatLength, sink->file);
+    }
+    return ferror(sink->file) ? 1 : 0;
+}
+
+ResultSink *OpenResultSink(const char *path, ResultFormat format, unsigned columns)
+{
+    int toStdout = strcmp(path, "-") == 0;
+    if (toStdout && format == RESULT_BINARY)
+    {
+        fprintf(stderr, "Binary results need an output file\n");
+        return NULL;
+    }
+    FILE *file = toStdout ? stdout : fopen(path, format == RESULT_BINARY ? "wb" : "w+");
+    if (file == NULL)
+    {
+        perror(path);
+        return NULL;
+    }
+    ResultSink *sink = calloc(1, sizeof(ResultSink));
+    sink->file = file;
+    sink->format = format;
+    sink->ring = malloc(sizeof(ResultRecord) * RING_CAPACITY);
+    addColumns(sink, columns);
+
+    if (format == RESULT_BINARY)
+    {
+        writeBinaryHeader(sink);
+    }
+    else
+    {
+        const char *names[MAX_RESULT_COLUMNS];
+        for (int c = 0; c < sink->numColumns; c++)
+        {
+            names[c] = sink->columns[c].name;
+        }
+        printHeader(names, sink->numColumns, file);
+    }
+    pthread_mutex_init(&sink->lock, NULL);
+    pthread_cond_init(&sink->wakeWriter, NULL);
+    pthread_cond_init(&sink->spaceFree, NULL);
+    pthread_cond_init(&sink->drained, NULL);
+    if (pthread_create(&sink->writer, NULL, drainResults, sink) != 0)
+    {
+        fprintf(stderr, "Cannot start the result writer thread\n");
+        sink->failed = 1;
+        CloseResultSink(sink);
+        return NULL;
+    }
+    return sink;
+}
+
+void PushResult(ResultSink *sink, const ResultRecord *record)
+{
+    pthread_mutex_lock(&sink->lock);
+    while (sink->count == RING_CAPACITY)
+    {
+        pthread_cond_wait(&sink->spaceFree, &sink->lock);
+    }
+    sink->ring[(sink->head + sink->count) % RING_CAPACITY] = *record;
+    sink->count++;
+    if (sink->count == RING_CAPACITY / 2)
+    {
+        pthread_cond_signal(&sink->wakeWriter);
+    }
+    pthread_mutex_unlock(&sink->lock);
+}
+
+void FlushResults(ResultSink *sink)
+{
+    pthread_mutex_lock(&sink->lock);
+    if (sink->count > 0)
+    {
+        sink->flushing = 1;
+        pthread_cond_signal(&sink->wakeWriter);
+    }
+    while (sink->count > 0)
+    {
+        pthread_cond_wait(&sink->drained, &sink->lock);
+    }
+    pthread_mutex_unlock(&sink->lock);
+}
+
+int CloseResultSink(ResultSink *sink)
+{
+    if (!sink->failed)
+    {
+        pthread_mutex_lock(&sink->lock);
+        sink->closing = 1;
+        pthread_cond_signal(&sink->wakeWriter);
+        pthread_mutex_unlock(&sink->lock);
+        pthread_join(sink->writer, NULL);
+    }
+    int failed = sink->failed || fflush(sink->file) != 0 || ferror(sink->file);
+    if (sink->file != stdout && fclose(sink->file) != 0)
+    {
+        failed = 1;
+    }
+    if (failed)
+    {
+        fprintf(stderr, "Writing the results failed\n");
+    }
+    pthread_mutex_destroy(&sink->lock);
+    pthread_cond_destroy(&sink->wakeWriter);
+    pthread_cond_destroy(&sink->spaceFree);
+    pthread_cond_destroy(&sink->drained);
+    free(sink->ring);
+    free(sink);
+    return failed ? 1 : 0;
+}
+
+/*
+ * Formats come from the file, so only the ones the sink writes are
+ * accepted: %d, %s and %.<digits> followed by f or g.
+ */
+static int isKnownFormat(ColumnType type, const char *format)
+{
+    if (type == COLUMN_INT)
+    {
+        return strcmp(format, "%d") == 0;
+    }
+    if (type == COLUMN_TEXT)
+    {
+        return strcmp(format, "%s") == 0;
+    }
+    if (strncmp(format, "%.", 2) != 0)
+    {
+        return 0;
+    }
+    const char *cursor = format + 2;
+    while (*cursor >= '0' && *cursor <= '9')
+    {
+        cursor++;
+    }
+    return cursor > format + 2 && (strcmp(cursor, "f") == 0 || strcmp(cursor, "g") == 0);
+}
+
+typedef struct StoredColumn
+{
+    ColumnType type;
+    char name[256];
+    char format[MAX_FORMAT_LENGTH];
+    void *values;
+    char *text;
+} StoredColumn;
+
+static int readString(FILE *file, char *buffer, size_t size)
+{
+    uint8_t length;
+    if (fread(&length, 1, 1, file) != 1 || length >= size || fread(buffer, 1, length, file) != length)
+    {
+        return 1;
+    }
+    buffer[length] = '\0';
+    return 0;
+}
+
+/*
+ * Reads the values of one column of a block; text is NUL separated. Sizes
+ * come from the file, so stored values and text that would not fit in the
+ * rest of it are rejected before anything is allocated for them.
+ */
+static int readColumnBlock(StoredColumn *column, uint32_t numRows, FILE *file, long long fileSize)
+{
+    uint8_t encoding;
+    if (fread(&encoding, 1, 1, file) != 1 || encoding > ENCODING_CONSTANT)
+    {
+        return 1;
+    }
+    uint32_t numStored = encoding == ENCODING_CONSTANT ? 1 : numRows;
+    size_t width = column->type == COLUMN_DOUBLE ? sizeof(double) : sizeof(int32_t);
+    if ((long long)width * numStored > fileSize - ftell(file))
+    {
+        return 1;
+    }
+    column->values = malloc(width * numRows + 1);
+    if (column->values == NULL || fread(column->values, width, numStored, file) != numStored)
+    {
+        return 1;
+    }
+    for (uint32_t r = numStored; r < numRows; r++)
+    {
+        memcpy((char *)column->values + r * width, column->values, width);
+    }
+    if (column->type != COLUMN_TEXT)
+    {
+        return 0;
+    }
+    long long stored = 0;
+    for (uint32_t r = 0; r < numStored; r++)
+    {
+        stored += ((uint32_t *)column->values)[r];
+    }
+    if (stored > fileSize - ftell(file))
+    {
+        return 1;
+    }
+    size_t total = 0;
+    for (uint32_t r = 0; r < numRows; r++)
+    {
+        total += ((uint32_t *)column->values)[r] + 1;
+    }
+    column->text = malloc(total + 1);
+    if (column->text == NULL)
+    {
+        return 1;
+    }
+    char *cursor = column->text;
+    for (uint32_t r = 0; r < numRows; r++)
+    {
+        uint32_t length = ((uint32_t *)column->values)[r];
+        if (r < numStored)
+        {
+            if (fread(cursor, 1, length, file) != length)
+            {
+                return 1;
+            }
+        }
+        else
+        {
+            memcpy(cursor, column->text, length);
+        }
+        cursor[length] = '\0';
+        cursor += length + 1;
+    }
+    return 0;
+}
+
+// The sink drains at most RING_CAPACITY rows into one block.
+static int convertBlocks(StoredColumn *columns, int numColumns, FILE *in, long long fileSize, FILE *out)
+{
+    uint32_t numRows;
+    while (fread(&numRows, sizeof(numRows), 1, in) == 1)
+    {
+        if (numRows == 0 || numRows > RING_CAPACITY)
+        {
+            return 1;
+        }
+        int failed = 0;
+        for (int c = 0; c < numColumns && !failed; c++)
+        {
+            failed = readColumnBlock(&columns[c], numRows, in, fileSize);
+        }
+        char **text = malloc(sizeof(char *) * numColumns);
+        for (int c = 0; c < numColumns; c++)
+        {
+            text[c] = columns[c].text;
+        }
+        for (uint32_t r = 0; r < numRows && !failed; r++)
+        {
+            for (int c = 0; c < numColumns; c++)
+            {
+                const StoredColumn *column = &columns[c];
+                if (c > 0)
+                {
+                    fputc(';', out);
+                }
+                printCell(column->type, column->format,
+                          column->type == COLUMN_INT ? ((int32_t *)column->values)[r] : 0,
+                          column->type == COLUMN_DOUBLE ? ((double *)column->values)[r] : 0, text[c], out);
+                if (column->type == COLUMN_TEXT)
+                {
+                    text[c] += strlen(text[c]) + 1;
+                }
+            }
+            fputc('\n', out);
+        }
+        free(text);
+        for (int c = 0; c < numColumns; c++)
+        {
+            free(columns[c].values);
+            free(columns[c].text);
+            columns[c].values = NULL;
+            columns[c].text = NULL;
+        }
+        if (failed)
+        {
+            return 1;
+        }
+    }
+    return ferror(in) ? 1 : 0;
+}
+
+int ConvertResultFile(const char *inPath, const char *outPath)
+{
+    FILE *in = fopen(inPath, "rb");
+    if (in == NULL)
+    {
+        perror(inPath);
+        return 1;
+    }
+    char header[sizeof(magic)];
+    uint32_t numColumns;
+    if (fread(header, sizeof(header), 1, in) != 1 || memcmp(header, magic, sizeof(magic)) != 0 ||
+        fread(&numColumns, sizeof(numColumns), 1, in) != 1 || numColumns == 0 || numColumns > MAX_RESULT_COLUMNS)
+    {
+        fprintf(stderr, "%s is not a binary result file\n", inPath);
+        fclose(in);
+        return 1;
+    }
+    StoredColumn columns[MAX_RESULT_COLUMNS] = {0};
+    const char *names[MAX_RESULT_COLUMNS];
+    for (uint32_t c = 0; c < numColumns; c++)
+    {
+        uint8_t type;
+        if (fread(&type, 1, 1, in) != 1 || type > COLUMN_TEXT ||
+            readString(in, columns[c].name, sizeof(columns[c].name)) != 0 ||
+            readString(in, columns[c].format, sizeof(columns[c].format)) != 0 ||
+            !isKnownFormat(type, columns[c].format))
+        {
+            fprintf(stderr, "%s: broken column header\n", inPath);
+            fclose(in);
+            return 1;
+        }
+        columns[c].type = type;
+        names[c] = columns[c].name;
+    }
+
+    FILE *out = strcmp(outPath, "-") == 0 ? stdout : fopen(outPath, "w+");
+    if (out == NULL)
+    {
+        perror(outPath);
+        fclose(in);
+        return 1;
+    }
+    printHeader(names, numColumns, out);
+    long long start = ftell(in);
+    fseek(in, 0, SEEK_END);
+    long long fileSize = ftell(in);
+    fseek(in, start, SEEK_SET);
+    int failed = convertBlocks(columns, numColumns, in, fileSize, out);
+    if (failed)
+    {
+        fprintf(stderr, "%s: truncated or corrupt block\n", inPath);
+    }
+    fclose(in);
+    if (out != stdout)
+    {
+        fclose(out);
+    }
+    return failed;
+}
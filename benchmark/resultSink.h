@@ -0,0 +1,99 @@
+#ifndef OPENMP_RESULT_SINK_H
+#define OPENMP_RESULT_SINK_H
+#endif
+
+#define MAX_RESULT_NAME_LENGTH 64
+#define MAX_RESULT_CPUS_LENGTH 2048
+#define MAX_RESULT_COUNTERS 8
+
+/*
+ * One output row of the registry harness. Doubles that are not available
+ * are NaN and written as NA; the optional fields are only written when
+ * their column set was requested.
+ */
+typedef struct ResultRecord
+{
+    char pages[16];
+    char group[MAX_RESULT_NAME_LENGTH];
+    char method[MAX_RESULT_NAME_LENGTH];
+    int size;
+    int numThreads;
+    int repetitions;
+    int outliers;
+    double min;
+    double median;
+    double mean;
+    double p90;
+    double p99;
+    double max;
+    double stddev;
+    double confidenceHalfWidth;
+    double bytes;
+    double operations;
+    double gigabytesPerSecond;
+    double gigaopsPerSecond;
+    double percentOfPeak;
+    int sizePerThread;
+    char workingSet[8];
+    double weakEfficiency;
+    double cpuTime;
+    double busyThreads;
+    int teamSize;
+    char cpus[MAX_RESULT_CPUS_LENGTH];
+    double iterationImbalance;
+    double busyImbalance;
+    double parallelEfficiency;
+    double baselineMedian;
+    double change;
+    double pValue;
+    char verdict[16];
+    double counters[MAX_RESULT_COUNTERS];
+} ResultRecord;
+
+// Optional column sets, in output order around the fixed columns.
+#define RESULT_PAGES 1
+#define RESULT_PLACEMENT 2
+#define RESULT_LOAD_BALANCE 4
+#define RESULT_COMPARISON 8
+#define RESULT_COUNTERS 16
+#define RESULT_SCALING 32
+#define RESULT_CPU_TIME 64
+
+typedef enum ResultFormat
+{
+    RESULT_CSV,
+    RESULT_BINARY
+} ResultFormat;
+
+/*
+ * Results are copied into a ring buffer and written by a background thread
+ * that is only woken once the buffer is half full, on FlushResults or when
+ * the sink is closed, so no formatting or I/O happens between timed calls;
+ * rows appear in batches. A full buffer blocks the producer rather than
+ * dropping rows.
+ *
+ * The binary format is columnar: an 8 byte magic "OMPRES01", a uint32
+ * column count and per column a uint8 type (0 int32, 1 float64, 2 text), a
+ * uint8 name length and the name, a uint8 length and the printf format
+ * used for CSV. Blocks of the rows drained at once follow until the end of the
+ * file: a uint32 row count of at most 256, then per column a uint8 encoding (0 plain, 1
+ * constant) and the values of all rows, or of the first row only when
+ * constant. Text values are uint32 lengths followed by the unterminated
+ * strings. All integers and doubles are in host byte order.
+ */
+typedef struct ResultSink ResultSink;
+
+// path "-" is stdout and only allowed for CSV. Returns NULL on error.
+ResultSink *OpenResultSink(const char *path, ResultFormat format, unsigned columns);
+
+void PushResult(ResultSink *sink, const ResultRecord *record);
+
+// Returns once the writer has written the rows pushed so far, so its I/O
+// does not overlap the measurements that follow.
+void FlushResults(ResultSink *sink);
+
+// Writes the remaining rows; returns 0, or 1 if writing failed.
+int CloseResultSink(ResultSink *sink);
+
+// Writes a binary result file as CSV to outPath ("-" for stdout).
+int ConvertResultFile(const char *inPath, const char *outPath);
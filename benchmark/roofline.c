@@ -0,0 +1,305 @@
+#include "roofline.h"
+#include "registry.h"
+#include "omp.h"
+#include "malloc.h"
+#include "stdio.h"
+#include "stdlib.h"
+
+#define PEAKS_VARIABLE "OPENMP_BENCHMARK_ROOFLINE"
+
+// Every array is well above the last level cache, as STREAM requires.
+#define STREAM_LENGTH (1 << 24)
+#define STREAM_SCALAR 3.0
+// Independent FMA chains per thread, enough to cover the FMA latency of
+// two vector units on current cores.
+#define PEAK_CHAINS 32
+#define PEAK_ITERATIONS (1 << 18)
+#define PEAK_MULTIPLIER 0.9999999
+#define PEAK_ADDEND 1e-7
+#define PEAK_INTEGER_MULTIPLIER 6364136223846793005ull
+#define PEAK_INTEGER_ADDEND 1442695040888963407ull
+// Time budget of each probe in milliseconds.
+#define PROBE_TIME 1000
+
+typedef struct StreamArrays
+{
+    double *a;
+    double *b;
+    double *c;
+    int length;
+} StreamArrays;
+
+static void *setupStream(int size, const void *parameters)
+{
+    StreamArrays *arrays = malloc(sizeof(StreamArrays));
+    arrays->a = malloc(sizeof(double) * size);
+    arrays->b = malloc(sizeof(double) * size);
+    arrays->c = malloc(sizeof(double) * size);
+    arrays->length = size;
+    double *a = arrays->a, *b = arrays->b, *c = arrays->c;
+    int i;
+    // First touch with the kernels' schedule so pages land next to the
+    // threads that stream them.
+#pragma omp parallel for schedule(static) shared(a, b, c, size) private(i) default(none)
+    for (i = 0; i < size; i++)
+    {
+        a[i] = 1.0;
+        b[i] = 2.0;
+        c[i] = 0.0;
+    }
+    return arrays;
+}
+
+static void teardownStream(void *input)
+{
+    StreamArrays *arrays = input;
+    free(arrays->a);
+    free(arrays->b);
+    free(arrays->c);
+    free(arrays);
+}
+
+static double streamCopy(StreamArrays *arrays)
+{
+    double *a = arrays->a, *c = arrays->c;
+    int length = arrays->length;
+    int i;
+#pragma omp parallel for simd schedule(static) shared(a, c, length) private(i) default(none)
+    for (i = 0; i < length; i++)
+    {
+        c[i] = a[i];
+    }
+    return c[length - 1];
+}
+
+static double streamTriad(StreamArrays *arrays)
+{
+    double *a = arrays->a, *b = arrays->b, *c = arrays->c;
+    int length = arrays->length;
+    int i;
+#pragma omp parallel for simd schedule(static) shared(a, b, c, length) private(i) default(none)
+    for (i = 0; i < length; i++)
+    {
+        a[i] = b[i] + STREAM_SCALAR * c[i];
+    }
+    return a[length - 1];
+}
+
+static double peakFma(int iterations)
+{
+    double total = 0;
+#pragma omp parallel shared(iterations) reduction(+ \
+                                                  : total) default(none)
+    {
+        double chains[PEAK_CHAINS];
+        for (int c = 0; c < PEAK_CHAINS; c++)
+        {
+            chains[c] = omp_get_thread_num() + c;
+        }
+        for (int i = 0; i < iterations; i++)
+        {
+#pragma omp simd
+            for (int c = 0; c < PEAK_CHAINS; c++)
+            {
+                chains[c] = chains[c] * PEAK_MULTIPLIER + PEAK_ADDEND;
+            }
+        }
+        for (int c = 0; c < PEAK_CHAINS; c++)
+        {
+            total += chains[c];
+        }
+    }
+    return total;
+}
+
+// Same chains in unsigned 64-bit integers, which wrap instead of overflowing.
+static double peakIntegerMultiplyAdd(int iterations)
+{
+    unsigned long long total = 0;
+#pragma omp parallel shared(iterations) reduction(+ \
+                                                  : total) default(none)
+    {
+        unsigned long long chains[PEAK_CHAINS];
+        for (int c = 0; c < PEAK_CHAINS; c++)
+        {
+            chains[c] = omp_get_thread_num() + c;
+        }
+        for (int i = 0; i < iterations; i++)
+        {
+#pragma omp simd
+            for (int c = 0; c < PEAK_CHAINS; c++)
+            {
+                chains[c] = chains[c] * PEAK_INTEGER_MULTIPLIER + PEAK_INTEGER_ADDEND;
+            }
+        }
+        for (int c = 0; c < PEAK_CHAINS; c++)
+        {
+            total += chains[c];
+        }
+    }
+    return (double)total;
+}
+
+// STREAM counts the bytes the kernel names, without write allocate traffic.
+static BenchmarkWork workStreamCopy(const void *input)
+{
+    const StreamArrays *arrays = input;
+    return (BenchmarkWork){.bytes = 2.0 * sizeof(double) * arrays->length, .operations = 0};
+}
+
+static BenchmarkWork workStreamTriad(const void *input)
+{
+    const StreamArrays *arrays = input;
+    return (BenchmarkWork){.bytes = 3.0 * sizeof(double) * arrays->length, .operations = 2.0 * arrays->length};
+}
+
+static void *setupPeakFma(int size, const void *parameters)
+{
+    int *iterations = malloc(sizeof(int));
+    *iterations = size;
+    return iterations;
+}
+
+static void teardownPeakFma(void *input)
+{
+    free(input);
+}
+
+// The team size is read at call time, when the harness has already set it.
+static BenchmarkWork workPeakFma(const void *input)
+{
+    return (BenchmarkWork){.bytes = 0,
+                           .operations = 2.0 * PEAK_CHAINS * *(const int *)input * omp_get_max_threads()};
+}
+
+static BenchmarkWork workPeakIntegerMultiplyAdd(const void *input)
+{
+    BenchmarkWork work = workPeakFma(input);
+    work.integerOperations = 1;
+    return work;
+}
+
+static double runStreamCopy(void *input)
+{
+    return streamCopy(input);
+}
+
+static double runStreamTriad(void *input)
+{
+    return streamTriad(input);
+}
+
+static double runPeakFma(void *input)
+{
+    return peakFma(*(int *)input);
+}
+
+static double runPeakIntegerMultiplyAdd(void *input)
+{
+    return peakIntegerMultiplyAdd(*(int *)input);
+}
+
+typedef struct ProbeCall
+{
+    double (*run)(void *input);
+    void *input;
+} ProbeCall;
+
+static volatile double probeSink;
+
+static void callProbe(void *context)
+{
+    ProbeCall *call = context;
+    probeSink = call->run(call->input);
+}
+
+// Best of the timed calls in seconds: ceilings are what the machine can
+// reach, not what it typically does.
+static double bestTime(double (*run)(void *input), void *input)
+{
+    MeasurementConfig config = GetDefaultMeasurementConfig();
+    config.maxTotalTime = PROBE_TIME;
+    ProbeCall call = {.run = run, .input = input};
+    MeasurementStats stats = MeasureCall(callProbe, NULL, &call, &config, NULL);
+    return stats.min / 1e3;
+}
+
+RooflinePeaks MeasureRooflinePeaks(int numThreads)
+{
+    RooflinePeaks peaks = {.numThreads = numThreads};
+    omp_set_num_threads(numThreads);
+
+    StreamArrays *arrays = setupStream(STREAM_LENGTH, NULL);
+    double copy = workStreamCopy(arrays).bytes / bestTime(runStreamCopy, arrays) / 1e9;
+    double triad = workStreamTriad(arrays).bytes / bestTime(runStreamTriad, arrays) / 1e9;
+    peaks.bandwidth = copy > triad ? copy : triad;
+    teardownStream(arrays);
+
+    int iterations = PEAK_ITERATIONS;
+    peaks.operations = workPeakFma(&iterations).operations / bestTime(runPeakFma, &iterations) / 1e9;
+    peaks.integerOperations =
+        workPeakFma(&iterations).operations / bestTime(runPeakIntegerMultiplyAdd, &iterations) / 1e9;
+    return peaks;
+}
+
+RooflinePeaks GetRooflinePeaks(int numThreads)
+{
+    RooflinePeaks peaks;
+    const char *shared = getenv(PEAKS_VARIABLE);
+    if (shared != NULL &&
+        sscanf(shared, "%d %lf %lf %lf", &peaks.numThreads, &peaks.bandwidth, &peaks.operations,
+               &peaks.integerOperations) == 4 &&
+        peaks.numThreads == numThreads)
+    {
+        return peaks;
+    }
+    return MeasureRooflinePeaks(numThreads);
+}
+
+void ShareRooflinePeaks(int numThreads)
+{
+    RooflinePeaks peaks = MeasureRooflinePeaks(numThreads);
+    char value[128];
+    snprintf(value, sizeof(value), "%d %.17g %.17g %.17g", peaks.numThreads, peaks.bandwidth, peaks.operations,
+             peaks.integerOperations);
+    setenv(PEAKS_VARIABLE, value, 1);
+}
+
+void RegisterRooflineBenchmarks()
+{
+    const BenchmarkGroup *group = RegisterBenchmarkGroup((BenchmarkGroup){
+        .name = "stream_copy",
+        .setup = setupStream,
+        .teardown = teardownStream,
+        .work = workStreamCopy,
+        .numDefaultSizes = 1,
+        .defaultSizes = {STREAM_LENGTH}});
+    RegisterBenchmark(group, "static", runStreamCopy, 1);
+
+    group = RegisterBenchmarkGroup((BenchmarkGroup){
+        .name = "stream_triad",
+        .setup = setupStream,
+        .teardown = teardownStream,
+        .work = workStreamTriad,
+        .numDefaultSizes = 1,
+        .defaultSizes = {STREAM_LENGTH}});
+    RegisterBenchmark(group, "static", runStreamTriad, 1);
+
+    group = RegisterBenchmarkGroup((BenchmarkGroup){
+        .name = "peak_fma",
+        .setup = setupPeakFma,
+        .teardown = teardownPeakFma,
+        .work = workPeakFma,
+        .numDefaultSizes = 1,
+        .defaultSizes = {PEAK_ITERATIONS}});
+    RegisterBenchmark(group, "fma", runPeakFma, 1);
+
+    group = RegisterBenchmarkGroup((BenchmarkGroup){
+        .name = "peak_madd_int64",
+        .setup = setupPeakFma,
+        .teardown = teardownPeakFma,
+        .work = workPeakIntegerMultiplyAdd,
+        .numDefaultSizes = 1,
+        .defaultSizes = {PEAK_ITERATIONS}});
+    RegisterBenchmark(group, "madd", runPeakIntegerMultiplyAdd, 1);
+}
@@ -0,0 +1,34 @@
+#ifndef OPENMP_ROOFLINE_H
+#define OPENMP_ROOFLINE_H
+#endif
+
+/*
+ * Machine ceilings for the roofline model: the best STREAM copy or triad
+ * bandwidth in GB/s and the best double precision FMA and 64-bit integer
+ * multiply-add throughput in Gop/s, all measured with numThreads threads.
+ * The probes are compiled with -O2 whatever the flags of the kernels, so
+ * they keep their chains in registers even in unoptimized builds. Without
+ * target flags they use the baseline instruction set (SSE2 multiply and
+ * add on x86-64), so kernels built with -march=native or -mfma can exceed
+ * them.
+ */
+typedef struct RooflinePeaks
+{
+    int numThreads;
+    double bandwidth;
+    double operations;
+    double integerOperations;
+} RooflinePeaks;
+
+RooflinePeaks MeasureRooflinePeaks(int numThreads);
+
+/*
+ * Peaks of the harness run: the ones a sweeping parent shared through the
+ * environment if there are any, measured otherwise. Sharing them once
+ * keeps the few seconds of probing out of every child process.
+ */
+RooflinePeaks GetRooflinePeaks(int numThreads);
+
+void ShareRooflinePeaks(int numThreads);
+
+void RegisterRooflineBenchmarks();
@@ -0,0 +1,446 @@
+#include "service.h"
+#include "registry.h"
+#include "../dotProduct/dotProduct.h"
+#include "../vectorMinValue/vectorMinValue.h"
+#include "../integrals/integrals.h"
+#include "../matrixMiniMax/matrixMiniMax.h"
+#include "omp.h"
+#include "limits.h"
+#include "math.h"
+#include "signal.h"
+#include "string.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define MAX_REQUEST_LENGTH 4096
+#define MAX_MAPPED_FILES 16
+#define MAX_CACHED_INPUTS 16
+
+typedef struct MappedFile
+{
+    char path[MAX_REQUEST_LENGTH];
+    int *data;
+    size_t length;
+    dev_t device;
+    ino_t inode;
+    struct timespec modified;
+    long long lastUse;
+} MappedFile;
+
+typedef struct CachedInput
+{
+    const BenchmarkGroup *group;
+    int size;
+    void *input;
+    long long lastUse;
+} CachedInput;
+
+typedef struct ServiceState
+{
+    MappedFile files[MAX_MAPPED_FILES];
+    int numFiles;
+    CachedInput inputs[MAX_CACHED_INPUTS];
+    int numInputs;
+    long long numRequests;
+    int stopping;
+} ServiceState;
+
+static void unmapFile(MappedFile *file)
+{
+    if (file->data != NULL)
+    {
+        munmap(file->data, file->length);
+    }
+    file->data = NULL;
+}
+
+/*
+ * Returns the mapping of path, mapping it on first use and again when the
+ * file was replaced or modified. The least recently used mapping makes
+ * room for a new one.
+ */
+static MappedFile *getMappedFile(ServiceState *state, const char *path, const char **error)
+{
+    struct stat status;
+    if (stat(path, &status) != 0)
+    {
+        *error = "cannot stat input";
+        return NULL;
+    }
+    MappedFile *file = NULL;
+    for (int i = 0; i < state->numFiles; i++)
+    {
+        if (strcmp(state->files[i].path, path) == 0)
+        {
+            file = &state->files[i];
+            break;
+        }
+    }
+    if (file != NULL && file->device == status.st_dev && file->inode == status.st_ino &&
+        file->length == (size_t)status.st_size && file->modified.tv_sec == status.st_mtim.tv_sec &&
+        file->modified.tv_nsec == status.st_mtim.tv_nsec)
+    {
+        file->lastUse = state->numRequests;
+        return file;
+    }
+    if (file == NULL)
+    {
+        if (state->numFiles < MAX_MAPPED_FILES)
+        {
+            file = &state->files[state->numFiles++];
+            file->data = NULL;
+        }
+        else
+        {
+            file = &state->files[0];
+            for (int i = 1; i < state->numFiles; i++)
+            {
+                if (state->files[i].lastUse < file->lastUse)
+                {
+                    file = &state->files[i];
+                }
+            }
+        }
+    }
+    unmapFile(file);
+    file->path[0] = '\0';
+    if (status.st_size < (off_t)sizeof(int))
+    {
+        *error = "input holds no ints";
+        return NULL;
+    }
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        *error = "cannot open input";
+        return NULL;
+    }
+    void *data = mmap(NULL, status.st_size, PROT_READ, MAP_SHARED | MAP_POPULATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        *error = "cannot map input";
+        return NULL;
+    }
+    snprintf(file->path, sizeof(file->path), "%s", path);
+    file->data = data;
+    file->length = status.st_size;
+    file->device = status.st_dev;
+    file->inode = status.st_ino;
+    file->modified = status.st_mtim;
+    file->lastUse = state->numRequests;
+    return file;
+}
+
+// Benchmark input of group for size, set up on first use and then kept.
+static void *getCachedInput(ServiceState *state, const BenchmarkGroup *group, int size)
+{
+    CachedInput *cached = NULL;
+    for (int i = 0; i < state->numInputs; i++)
+    {
+        if (state->inputs[i].group == group && state->inputs[i].size == size)
+        {
+            cached = &state->inputs[i];
+            cached->lastUse = state->numRequests;
+            return cached->input;
+        }
+    }
+    if (state->numInputs < MAX_CACHED_INPUTS)
+    {
+        cached = &state->inputs[state->numInputs++];
+    }
+    else
+    {
+        cached = &state->inputs[0];
+        for (int i = 1; i < state->numInputs; i++)
+        {
+            if (state->inputs[i].lastUse < cached->lastUse)
+            {
+                cached = &state->inputs[i];
+            }
+        }
+        cached->group->teardown(cached->input);
+    }
+    cached->group = group;
+    cached->size = size;
+    cached->input = group->setup(size, group->parameters);
+    cached->lastUse = state->numRequests;
+    return cached->input;
+}
+
+static const Benchmark *findBenchmark(const char *name)
+{
+    for (int i = 0; i < GetBenchmarkCount(); i++)
+    {
+        const Benchmark *benchmark = GetBenchmark(i);
+        size_t groupLength = strlen(benchmark->group->name);
+        if (strncmp(name, benchmark->group->name, groupLength) == 0 && name[groupLength] == '/' &&
+            strcmp(name + groupLength + 1, benchmark->method) == 0)
+        {
+            return benchmark;
+        }
+    }
+    return NULL;
+}
+
+// Number of ints to use from a file: all of them, or count if it fits.
+static long long getIntCount(const MappedFile *file, long long count)
+{
+    long long available = file->length / sizeof(int);
+    return count <= 0 ? available : count <= available ? count : -1;
+}
+
+/*
+ * Parses and runs one request and writes its response to out. Returns 0
+ * to keep the connection, 1 to close it.
+ */
+static int handleRequest(ServiceState *state, char *request, FILE *out)
+{
+    double requestStart = omp_get_wtime();
+    state->numRequests++;
+    char command[32];
+    char first[MAX_REQUEST_LENGTH], second[MAX_REQUEST_LENGTH];
+    int consumed = 0;
+    if (sscanf(request, "%31s%n", command, &consumed) != 1)
+    {
+        return 0;
+    }
+    const char *arguments = request + consumed;
+    const char *error = NULL;
+    double result = NAN;
+    double kernelStart = 0, kernelEnd = 0;
+
+    if (strcmp(command, "quit") == 0)
+    {
+        return 1;
+    }
+    else if (strcmp(command, "shutdown") == 0)
+    {
+        state->stopping = 1;
+        return 1;
+    }
+    else if (strcmp(command, "min") == 0)
+    {
+        long long count = 0;
+        MappedFile *file;
+        if (sscanf(arguments, "%4095s %lld", first, &count) < 1)
+        {
+            error = "usage: min PATH [COUNT]";
+        }
+        else if ((file = getMappedFile(state, first, &error)) != NULL)
+        {
+            count = getIntCount(file, count);
+            if (count < 0 || count > INT_MAX)
+            {
+                error = "bad count";
+            }
+            else
+            {
+                kernelStart = omp_get_wtime();
+                result = FindMinWithReduction(file->data, (int)count);
+                kernelEnd = omp_get_wtime();
+            }
+        }
+    }
+    else if (strcmp(command, "dot") == 0)
+    {
+        long long count = 0;
+        MappedFile *a, *b;
+        if (sscanf(arguments, "%4095s %4095s %lld", first, second, &count) < 2)
+        {
+            error = "usage: dot PATH PATH [COUNT]";
+        }
+        else if ((a = getMappedFile(state, first, &error)) != NULL &&
+                 (b = getMappedFile(state, second, &error)) != NULL)
+        {
+            long long countA = getIntCount(a, count);
+            long long countB = getIntCount(b, count);
+            if (countA < 0 || countA != countB || countA > INT_MAX)
+            {
+                error = "inputs differ in length or are shorter than COUNT";
+            }
+            else
+            {
+                kernelStart = omp_get_wtime();
+                result = dotProductWithReduction(a->data, b->data, (int)countA, (int)countB);
+                kernelEnd = omp_get_wtime();
+            }
+        }
+    }
+    else if (strcmp(command, "minimax") == 0)
+    {
+        int rows, cols;
+        MappedFile *file;
+        if (sscanf(arguments, "%4095s %d %d", first, &rows, &cols) != 3 || rows <= 0 || cols <= 0)
+        {
+            error = "usage: minimax PATH ROWS COLS";
+        }
+        else if ((file = getMappedFile(state, first, &error)) != NULL)
+        {
+            if (getIntCount(file, (long long)rows * cols) < 0)
+            {
+                error = "input is shorter than ROWS * COLS";
+            }
+            else
+            {
+                kernelStart = omp_get_wtime();
+                result = FindMiniMaxWithReduction(file->data, rows, cols);
+                kernelEnd = omp_get_wtime();
+            }
+        }
+    }
+    else if (strcmp(command, "integral") == 0)
+    {
+        double left, right;
+        int numRects;
+        if (sscanf(arguments, "%lf %lf %d", &left, &right, &numRects) != 3 || numRects <= 0)
+        {
+            error = "usage: integral LEFT RIGHT RECTS";
+        }
+        else
+        {
+            kernelStart = omp_get_wtime();
+            result = IntegrateWithReduction(exp, left, right, numRects);
+            kernelEnd = omp_get_wtime();
+        }
+    }
+    else if (strcmp(command, "run") == 0)
+    {
+        int size;
+        const Benchmark *benchmark;
+        if (sscanf(arguments, "%4095s %d", first, &size) != 2 || size <= 0)
+        {
+            error = "usage: run GROUP/METHOD SIZE";
+        }
+        else if ((benchmark = findBenchmark(first)) == NULL)
+        {
+            error = "unknown benchmark";
+        }
+        else
+        {
+            void *input = getCachedInput(state, benchmark->group, size);
+            if (benchmark->group->reset != NULL)
+            {
+                benchmark->group->reset(input);
+            }
+            kernelStart = omp_get_wtime();
+            result = benchmark->run(input);
+            kernelEnd = omp_get_wtime();
+        }
+    }
+    else
+    {
+        error = "unknown request";
+    }
+
+    if (error != NULL)
+    {
+        fprintf(out, "error %s\n", error);
+    }
+    else
+    {
+        fprintf(out, "ok %.17g %.6f %.6f\n", result, (kernelEnd - kernelStart) * 1000,
+                (omp_get_wtime() - requestStart) * 1000);
+    }
+    fflush(out);
+    return 0;
+}
+
+static void serveStream(ServiceState *state, FILE *in, FILE *out)
+{
+    char request[MAX_REQUEST_LENGTH];
+    while (fgets(request, sizeof(request), in) != NULL)
+    {
+        if (strchr(request, '\n') == NULL && !feof(in))
+        {
+            fprintf(out, "error request too long\n");
+            fflush(out);
+            int c;
+            while ((c = fgetc(in)) != EOF && c != '\n')
+            {
+            }
+            continue;
+        }
+        if (handleRequest(state, request, out) != 0)
+        {
+            break;
+        }
+    }
+}
+
+// Requests are served one connection at a time: every kernel uses the
+// whole team, so concurrent ones would only slow each other down.
+static int serveSocket(ServiceState *state, const char *path)
+{
+    struct sockaddr_un address = {.sun_family = AF_UNIX};
+    if (strlen(path) >= sizeof(address.sun_path))
+    {
+        fprintf(stderr, "Socket path is too long: %s\n", path);
+        return 1;
+    }
+    strcpy(address.sun_path, path);
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(path);
+    if (listener < 0 || bind(listener, (struct sockaddr *)&address, sizeof(address)) != 0 || listen(listener, 8) != 0)
+    {
+        perror(path);
+        if (listener >= 0)
+        {
+            close(listener);
+        }
+        return 1;
+    }
+    fprintf(stderr, "Serving on %s\n", path);
+    while (!state->stopping)
+    {
+        int connection = accept(listener, NULL, NULL);
+        if (connection < 0)
+        {
+            continue;
+        }
+        FILE *in = fdopen(connection, "r");
+        FILE *out = fdopen(dup(connection), "w");
+        serveStream(state, in, out);
+        fclose(in);
+        fclose(out);
+    }
+    close(listener);
+    unlink(path);
+    return 0;
+}
+
+int RunService(const char *path, int numThreads)
+{
+    static ServiceState state;
+    // A client that hangs up must not take the service down with it.
+    signal(SIGPIPE, SIG_IGN);
+    omp_set_num_threads(numThreads);
+#pragma omp parallel
+    {
+        // Starts the team once; later regions reuse its threads.
+    }
+
+    int status = 0;
+    if (strcmp(path, "-") == 0)
+    {
+        serveStream(&state, stdin, stdout);
+    }
+    else
+    {
+        status = serveSocket(&state, path);
+    }
+
+    for (int i = 0; i < state.numFiles; i++)
+    {
+        unmapFile(&state.files[i]);
+    }
+    for (int i = 0; i < state.numInputs; i++)
+    {
+        state.inputs[i].group->teardown(state.inputs[i].input);
+    }
+    return status;
+}
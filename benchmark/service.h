@@ -0,0 +1,24 @@
+#ifndef OPENMP_SERVICE_H
+#define OPENMP_SERVICE_H
+#endif
+
+/*
+ * Long-lived kernel service. One request per line, one response line
+ * each, over a Unix domain socket at path or over stdin and stdout when
+ * path is "-":
+ *
+ *   min PATH [COUNT]             minimum of a file of native ints
+ *   dot PATH PATH [COUNT]        dot product of two such files
+ *   minimax PATH ROWS COLS       largest row minimum of a row-major matrix
+ *   integral LEFT RIGHT RECTS    midpoint rule for exp
+ *   run GROUP/METHOD SIZE        a registered benchmark on its own input
+ *   quit                         closes the connection
+ *   shutdown                     stops the service
+ *
+ * Responses are "ok RESULT KERNEL_MS REQUEST_MS" or "error MESSAGE";
+ * KERNEL_MS times the kernel alone, REQUEST_MS also parsing and mapping.
+ * The thread team is started once, input files stay mapped and benchmark
+ * inputs stay allocated between requests, so only the first request for
+ * an input pays for page faults.
+ */
+int RunService(const char *path, int numThreads);
@@ -0,0 +1,172 @@
+#define _GNU_SOURCE
+#include "waitPolicy.h"
+#include "measurement.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include <dlfcn.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define CHILD_VARIABLE "OPENMP_BENCHMARK_WAIT_POLICY_CHILD"
+#define NUM_SPIN_SETTINGS 4
+
+// NULL leaves the runtime default, listed as "default".
+static const char *waitPolicies[] = {NULL, "active", "passive"};
+static const char *dynamicSettings[] = {"false", "true"};
+// Spins before a waiting libgomp thread sleeps; the default is 300000, or
+// practically forever with OMP_WAIT_POLICY=active and none with passive.
+static const char *spinCounts[NUM_SPIN_SETTINGS] = {NULL, "0", "10000", "1000000"};
+// Milliseconds a waiting libomp thread spins before it sleeps; the default
+// is 200, and 0 with OMP_WAIT_POLICY=passive.
+static const char *blockTimes[NUM_SPIN_SETTINGS] = {NULL, "0", "1", "20"};
+
+typedef struct WaitSettings
+{
+    const char *waitPolicy;
+    const char *spinVariable;
+    const char *spin;
+    const char *dynamic;
+} WaitSettings;
+
+int IsWaitPolicySweepChild()
+{
+    return getenv(CHILD_VARIABLE) != NULL;
+}
+
+// kmp_* is libomp's own API; libgomp does not export it.
+const char *GetOpenMPRuntimeName()
+{
+    return dlsym(RTLD_DEFAULT, "kmp_set_blocktime") != NULL ? "libomp" : "libgomp";
+}
+
+static void setOrUnset(const char *name, const char *value)
+{
+    if (value != NULL)
+    {
+        setenv(name, value, 1);
+    }
+    else
+    {
+        unsetenv(name);
+    }
+}
+
+static const char *label(const char *value)
+{
+    return value != NULL ? value : "default";
+}
+
+/*
+ * Runs one child with the given settings. The child's header is copied
+ * once, data rows always; the child's wall and CPU time are reported on
+ * stderr.
+ */
+static int runChild(char *argv[], const char *runtime, const WaitSettings *settings, int *headerWritten,
+                    FILE *file)
+{
+    int fds[2];
+    if (pipe(fds) != 0)
+    {
+        perror("pipe");
+        return 1;
+    }
+    fflush(file);
+    double start = GetSteadyTimeMs();
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        perror("fork");
+        close(fds[0]);
+        close(fds[1]);
+        return 1;
+    }
+    if (pid == 0)
+    {
+        dup2(fds[1], STDOUT_FILENO);
+        close(fds[0]);
+        close(fds[1]);
+        setenv(CHILD_VARIABLE, "1", 1);
+        setOrUnset("OMP_WAIT_POLICY", settings->waitPolicy);
+        setOrUnset(settings->spinVariable, settings->spin);
+        setenv("OMP_DYNAMIC", settings->dynamic, 1);
+        execv("/proc/self/exe", argv);
+        perror("execv");
+        _exit(127);
+    }
+
+    close(fds[1]);
+    FILE *output = fdopen(fds[0], "r");
+    char *line = NULL;
+    size_t capacity = 0;
+    int isHeader = 1;
+    while (getline(&line, &capacity, output) != -1)
+    {
+        if (isHeader)
+        {
+            isHeader = 0;
+            if (*headerWritten)
+            {
+                continue;
+            }
+            *headerWritten = 1;
+            fprintf(file, "runtime;wait_policy;spin;dynamic;%s", line);
+            continue;
+        }
+        fprintf(file, "%s;%s;%s;%s;%s", runtime, label(settings->waitPolicy), label(settings->spin),
+                settings->dynamic, line);
+    }
+    free(line);
+    fclose(output);
+
+    int status;
+    struct rusage usage;
+    wait4(pid, &status, 0, &usage);
+    double wallTime = (GetSteadyTimeMs() - start) / 1e3;
+    double cpuTime = usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+                     (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+    fprintf(stderr, "OMP_WAIT_POLICY=%s %s=%s OMP_DYNAMIC=%s: %.2f s wall, %.2f s CPU (%.2f cores busy)\n",
+            label(settings->waitPolicy), settings->spinVariable, label(settings->spin), settings->dynamic, wallTime,
+            cpuTime, cpuTime / wallTime);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+        fprintf(stderr, "Wait policy sweep child failed\n");
+        return 1;
+    }
+    return 0;
+}
+
+int RunWaitPolicySweep(char *argv[], const char *outPath)
+{
+    FILE *file = strcmp(outPath, "-") == 0 ? stdout : fopen(outPath, "w+");
+    if (file == NULL)
+    {
+        perror(outPath);
+        return 1;
+    }
+    const char *runtime = GetOpenMPRuntimeName();
+    int isLibomp = strcmp(runtime, "libomp") == 0;
+    int headerWritten = 0;
+    int failures = 0;
+    for (int w = 0; w < 3; w++)
+    {
+        for (int s = 0; s < NUM_SPIN_SETTINGS; s++)
+        {
+            for (int d = 0; d < 2; d++)
+            {
+                WaitSettings settings = {.waitPolicy = waitPolicies[w],
+                                         .spinVariable = isLibomp ? "KMP_BLOCKTIME" : "GOMP_SPINCOUNT",
+                                         .spin = isLibomp ? blockTimes[s] : spinCounts[s],
+                                         .dynamic = dynamicSettings[d]};
+                failures += runChild(argv, runtime, &settings, &headerWritten, file);
+            }
+        }
+    }
+
+    if (file != stdout)
+    {
+        fclose(file);
+    }
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,24 @@
+#ifndef OPENMP_WAIT_POLICY_H
+#define OPENMP_WAIT_POLICY_H
+#endif
+
+/*
+ * How idle workers wait between and inside regions is fixed when the
+ * runtime starts, so the sweep re-runs the program in a child process per
+ * OMP_WAIT_POLICY, spin setting and OMP_DYNAMIC value and merges the
+ * children's CSV rows, prefixed with the runtime and all three settings,
+ * into outPath. The spin setting is GOMP_SPINCOUNT under libgomp and
+ * KMP_BLOCKTIME under LLVM libomp, whichever the program is linked with
+ * (see OPENMP_RUNTIME in CMakeLists.txt). Children run with the same
+ * arguments and record the CPU time of their calls, so every row holds the
+ * latency and what it cost, and the team size the runtime granted, which
+ * OMP_DYNAMIC may shrink below num_threads. The wall and CPU time of every
+ * child as a whole, idle spinning included, go to stderr.
+ */
+int RunWaitPolicySweep(char *argv[], const char *outPath);
+
+// True in a child started by RunWaitPolicySweep.
+int IsWaitPolicySweepChild();
+
+// "libomp" if the program runs on LLVM libomp, "libgomp" otherwise.
+const char *GetOpenMPRuntimeName();
@@ -0,0 +1,181 @@
+#define _GNU_SOURCE
+#include "hugePages.h"
+#include <errno.h>
+#include <malloc.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+#ifndef MAP_HUGE_2MB
+#define MAP_HUGE_2MB (21 << MAP_HUGE_SHIFT)
+#endif
+#ifndef MAP_HUGE_1GB
+#define MAP_HUGE_1GB (30 << MAP_HUGE_SHIFT)
+#endif
+
+#define HUGE_PAGE_SIZE (2UL << 20)
+#define GIGANTIC_PAGE_SIZE (1UL << 30)
+// Keeps the data cache line aligned behind the header.
+#define HEADER_SIZE 64
+
+typedef struct AllocationHeader
+{
+    PageKind kind;
+    size_t mappedSize;
+} AllocationHeader;
+
+static PageKind currentKind = PAGES_MALLOC;
+// PAGE_KIND_COUNT until an allocation of at least one huge page is made.
+static PageKind grantedKind = PAGE_KIND_COUNT;
+static int warnedFallback[PAGE_KIND_COUNT];
+
+static const char *pageKindNames[] = {"malloc", "4k", "thp", "2m", "1g"};
+
+void SetPageKind(PageKind kind)
+{
+    currentKind = kind;
+    grantedKind = PAGE_KIND_COUNT;
+}
+
+void ResetGrantedPageKind()
+{
+    grantedKind = PAGE_KIND_COUNT;
+}
+
+PageKind GetGrantedPageKind()
+{
+    return grantedKind < PAGE_KIND_COUNT ? grantedKind : PAGES_MALLOC;
+}
+
+PageKind GetPageKind()
+{
+    return currentKind;
+}
+
+const char *GetPageKindName(PageKind kind)
+{
+    return kind < PAGE_KIND_COUNT ? pageKindNames[kind] : "unknown";
+}
+
+int ParsePageKind(const char *name, PageKind *kind)
+{
+    for (int k = 0; k < PAGE_KIND_COUNT; k++)
+    {
+        if (strcmp(name, pageKindNames[k]) == 0)
+        {
+            *kind = k;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static size_t roundUp(size_t size, size_t alignment)
+{
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+static void *mapPages(PageKind kind, size_t size, size_t *mappedSize)
+{
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    size_t pageSize = HUGE_PAGE_SIZE;
+    if (kind == PAGES_HUGETLB_2MB)
+    {
+        flags |= MAP_HUGETLB | MAP_HUGE_2MB;
+    }
+    else if (kind == PAGES_HUGETLB_1GB)
+    {
+        flags |= MAP_HUGETLB | MAP_HUGE_1GB;
+        pageSize = GIGANTIC_PAGE_SIZE;
+    }
+    *mappedSize = roundUp(size, pageSize);
+    // Transparent huge pages need 2 MB aligned ranges, so the mapping is
+    // over-allocated by one huge page and trimmed.
+    size_t slack = kind == PAGES_TRANSPARENT ? HUGE_PAGE_SIZE : 0;
+    char *mapping = mmap(NULL, *mappedSize + slack, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if (mapping == MAP_FAILED)
+    {
+        return NULL;
+    }
+    char *pointer = mapping;
+    if (slack > 0)
+    {
+        pointer = (char *)roundUp((size_t)mapping, HUGE_PAGE_SIZE);
+        if (pointer > mapping)
+        {
+            munmap(mapping, pointer - mapping);
+        }
+        if (mapping + slack > pointer)
+        {
+            munmap(pointer + *mappedSize, mapping + slack - pointer);
+        }
+    }
+    if (kind == PAGES_SMALL || kind == PAGES_TRANSPARENT)
+    {
+        if (madvise(pointer, *mappedSize, kind == PAGES_SMALL ? MADV_NOHUGEPAGE : MADV_HUGEPAGE) != 0)
+        {
+            munmap(pointer, *mappedSize);
+            return NULL;
+        }
+    }
+    return pointer;
+}
+
+void *AllocatePages(size_t size)
+{
+    size_t total = size + HEADER_SIZE;
+    PageKind kind = total < HUGE_PAGE_SIZE ? PAGES_MALLOC : currentKind;
+    void *base = NULL;
+    size_t mappedSize = 0;
+    while (kind != PAGES_MALLOC)
+    {
+        base = mapPages(kind, total, &mappedSize);
+        if (base != NULL)
+        {
+            break;
+        }
+        if (!warnedFallback[kind])
+        {
+            warnedFallback[kind] = 1;
+            fprintf(stderr, "%s pages are not available (%s), falling back\n", GetPageKindName(kind), strerror(errno));
+        }
+        // 1g -> 2m -> thp -> 4k -> malloc
+        kind = kind == PAGES_SMALL ? PAGES_MALLOC : kind - 1;
+    }
+    if (kind == PAGES_MALLOC)
+    {
+        base = malloc(total);
+        if (base == NULL)
+        {
+            return NULL;
+        }
+    }
+    if (total >= HUGE_PAGE_SIZE && kind < grantedKind)
+    {
+        grantedKind = kind;
+    }
+    AllocationHeader *header = base;
+    header->kind = kind;
+    header->mappedSize = mappedSize;
+    return (char *)base + HEADER_SIZE;
+}
+
+void FreePages(void *pointer)
+{
+    if (pointer == NULL)
+    {
+        return;
+    }
+    AllocationHeader *header = (AllocationHeader *)((char *)pointer - HEADER_SIZE);
+    if (header->kind == PAGES_MALLOC)
+    {
+        free(header);
+    }
+    else
+    {
+        munmap(header, header->mappedSize);
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef OPENMP_HUGE_PAGES_H
+#define OPENMP_HUGE_PAGES_H
+#endif
+
+#include <stddef.h>
+
+/*
+ * Backing of large benchmark arrays. PAGES_MALLOC is plain malloc and the
+ * default; PAGES_SMALL forces 4 KB pages with MADV_NOHUGEPAGE,
+ * PAGES_TRANSPARENT asks for transparent huge pages with MADV_HUGEPAGE and
+ * PAGES_HUGETLB_2MB / PAGES_HUGETLB_1GB map reserved huge pages
+ * (vm.nr_hugepages, hugepagesz=1G) with MAP_HUGETLB. A kind that cannot be
+ * satisfied falls back to the next weaker one down to malloc, with a
+ * warning on stderr.
+ */
+typedef enum PageKind
+{
+    PAGES_MALLOC,
+    PAGES_SMALL,
+    PAGES_TRANSPARENT,
+    PAGES_HUGETLB_2MB,
+    PAGES_HUGETLB_1GB,
+    PAGE_KIND_COUNT
+} PageKind;
+
+// Kind used by AllocatePages from now on, InitMatrix included.
+void SetPageKind(PageKind kind);
+
+PageKind GetPageKind();
+
+// Weakest kind handed to allocations of at least one huge page since
+// SetPageKind or ResetGrantedPageKind; PAGES_MALLOC if there were none, as
+// smaller allocations always use it.
+PageKind GetGrantedPageKind();
+
+void ResetGrantedPageKind();
+
+const char *GetPageKindName(PageKind kind);
+
+// Returns 0 and sets kind if name is one of the GetPageKindName names.
+int ParsePageKind(const char *name, PageKind *kind);
+
+// Allocations below one huge page always use malloc.
+void *AllocatePages(size_t size);
+
+void FreePages(void *pointer);
@@ -2,12 +2,13 @@
 // Created by GSlepenkov on 26.09.2022.
 //
 #include "matrix.h"
+#include "hugePages.h"
 #include <malloc.h>
 
 Matrix *InitMatrix(int nRows, int nCols)
 {
     Matrix *matrix = malloc(sizeof(Matrix));
-    matrix->data = malloc(nRows * nCols * sizeof(int));
+    matrix->data = AllocatePages((size_t)nRows * nCols * sizeof(int));
     matrix->nRows = nRows;
     matrix->nCols = nCols;
     return matrix;
@@ -32,7 +33,7 @@ int GetMatrixElem(Matrix *matrix, int row, int col)
 
 void FreeMatrix(Matrix *matrix)
 {
-    free(matrix->data);
+    FreePages(matrix->data);
     matrix->data = NULL;
     matrix->nCols = 0;
     matrix->nRows = 0;
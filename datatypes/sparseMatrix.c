@@ -0,0 +1,355 @@
+#include "matrix.h"
+#include "sparseMatrix.h"
+#include "hugePages.h"
+#include "malloc.h"
+#include "math.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+
+#define MAX_LINE_LENGTH 1024
+
+static SparseMatrix *allocateSparse(int nRows, int nCols, long long numEntries)
+{
+    SparseMatrix *matrix = malloc(sizeof(SparseMatrix));
+    matrix->nRows = nRows;
+    matrix->nCols = nCols;
+    matrix->rowStarts = malloc(sizeof(int) * (nRows + 1));
+    matrix->colIndices = AllocatePages(sizeof(int) * (numEntries > 0 ? numEntries : 1));
+    matrix->values = AllocatePages(sizeof(int) * (numEntries > 0 ? numEntries : 1));
+    return matrix;
+}
+
+SparseMatrix *SparseFromMatrix(Matrix *matrix)
+{
+    long long numEntries = 0;
+    for (long long i = 0; i < (long long)matrix->nRows * matrix->nCols; i++)
+    {
+        numEntries += matrix->data[i] != 0;
+    }
+    SparseMatrix *sparse = allocateSparse(matrix->nRows, matrix->nCols, numEntries);
+    int entry = 0;
+    for (int i = 0; i < matrix->nRows; i++)
+    {
+        sparse->rowStarts[i] = entry;
+        for (int j = 0; j < matrix->nCols; j++)
+        {
+            int value = GetMatrixElem(matrix, i, j);
+            if (value != 0)
+            {
+                sparse->colIndices[entry] = j;
+                sparse->values[entry] = value;
+                entry++;
+            }
+        }
+    }
+    sparse->rowStarts[matrix->nRows] = entry;
+    return sparse;
+}
+
+// Skips the banner and comment lines and returns the dimensions line.
+static int readSizeLine(FILE *file, char *line, int *isPattern, int *isSymmetric)
+{
+    char object[32], format[32], field[32], symmetry[32];
+    if (fgets(line, MAX_LINE_LENGTH, file) == NULL ||
+        sscanf(line, "%%%%MatrixMarket %31s %31s %31s %31s", object, format, field, symmetry) != 4 ||
+        strcmp(object, "matrix") != 0 || strcmp(format, "coordinate") != 0 ||
+        (strcmp(field, "integer") != 0 && strcmp(field, "real") != 0 && strcmp(field, "pattern") != 0) ||
+        (strcmp(symmetry, "general") != 0 && strcmp(symmetry, "symmetric") != 0))
+    {
+        return 1;
+    }
+    *isPattern = strcmp(field, "pattern") == 0;
+    *isSymmetric = strcmp(symmetry, "symmetric") == 0;
+    do
+    {
+        if (fgets(line, MAX_LINE_LENGTH, file) == NULL)
+        {
+            return 1;
+        }
+    } while (line[0] == '%');
+    return 0;
+}
+
+int ReadSparseCoordinatesSize(const char *path, int *nRows, int *nCols)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+    {
+        perror(path);
+        return 1;
+    }
+    char line[MAX_LINE_LENGTH];
+    int isPattern, isSymmetric;
+    int failed = readSizeLine(file, line, &isPattern, &isSymmetric) != 0 || sscanf(line, "%d %d", nRows, nCols) != 2;
+    if (failed)
+    {
+        fprintf(stderr, "%s: not a supported Matrix Market coordinate file\n", path);
+    }
+    fclose(file);
+    return failed;
+}
+
+SparseMatrix *ReadSparseCoordinates(const char *path)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+    {
+        perror(path);
+        return NULL;
+    }
+    char line[MAX_LINE_LENGTH];
+    int isPattern, isSymmetric;
+    int nRows, nCols;
+    long long numLines;
+    if (readSizeLine(file, line, &isPattern, &isSymmetric) != 0 ||
+        sscanf(line, "%d %d %lld", &nRows, &nCols, &numLines) != 3 || nRows <= 0 || nCols <= 0 || numLines < 0)
+    {
+        fprintf(stderr, "%s: not a supported Matrix Market coordinate file\n", path);
+        fclose(file);
+        return NULL;
+    }
+
+    // Coordinates first, then a counting sort by row into CSR.
+    long long capacity = isSymmetric ? 2 * numLines : numLines;
+    int *rows = malloc(sizeof(int) * (capacity > 0 ? capacity : 1));
+    int *cols = malloc(sizeof(int) * (capacity > 0 ? capacity : 1));
+    int *values = malloc(sizeof(int) * (capacity > 0 ? capacity : 1));
+    long long numEntries = 0;
+    for (long long n = 0; n < numLines; n++)
+    {
+        int row, col;
+        double value = 1;
+        if (fgets(line, MAX_LINE_LENGTH, file) == NULL ||
+            sscanf(line, isPattern ? "%d %d" : "%d %d %lf", &row, &col, &value) != (isPattern ? 2 : 3) ||
+            row < 1 || row > nRows || col < 1 || col > nCols)
+        {
+            fprintf(stderr, "%s: bad entry %lld\n", path, n + 1);
+            free(rows);
+            free(cols);
+            free(values);
+            fclose(file);
+            return NULL;
+        }
+        rows[numEntries] = row - 1;
+        cols[numEntries] = col - 1;
+        values[numEntries++] = (int)lround(value);
+        if (isSymmetric && row != col)
+        {
+            rows[numEntries] = col - 1;
+            cols[numEntries] = row - 1;
+            values[numEntries++] = (int)lround(value);
+        }
+    }
+    fclose(file);
+
+    SparseMatrix *matrix = allocateSparse(nRows, nCols, numEntries);
+    memset(matrix->rowStarts, 0, sizeof(int) * (nRows + 1));
+    for (long long n = 0; n < numEntries; n++)
+    {
+        matrix->rowStarts[rows[n] + 1]++;
+    }
+    for (int r = 0; r < nRows; r++)
+    {
+        matrix->rowStarts[r + 1] += matrix->rowStarts[r];
+    }
+    int *next = malloc(sizeof(int) * nRows);
+    memcpy(next, matrix->rowStarts, sizeof(int) * nRows);
+    for (long long n = 0; n < numEntries; n++)
+    {
+        int entry = next[rows[n]]++;
+        matrix->colIndices[entry] = cols[n];
+        matrix->values[entry] = values[n];
+    }
+    free(next);
+    free(rows);
+    free(cols);
+    free(values);
+    return matrix;
+}
+
+static unsigned int nextRandom(unsigned int *state)
+{
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static double nextUniform(unsigned int *state)
+{
+    return (nextRandom(state) + 0.5) / 4294967296.0;
+}
+
+static int compareInts(const void *a, const void *b)
+{
+    int x = *(const int *)a;
+    int y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+SparseMatrix *InitPowerLawSparse(int nRows, int nCols, int meanRowLength, double alpha)
+{
+    unsigned int state = 0x9E3779B9u;
+    int *lengths = malloc(sizeof(int) * nRows);
+    long long numEntries = 0;
+    for (int r = 0; r < nRows; r++)
+    {
+        double length = meanRowLength;
+        if (alpha > 1)
+        {
+            length = meanRowLength * (alpha - 1) / alpha / pow(nextUniform(&state), 1.0 / alpha);
+        }
+        lengths[r] = length < 1 ? 1 : length > nCols ? nCols : (int)length;
+        numEntries += lengths[r];
+    }
+
+    SparseMatrix *matrix = allocateSparse(nRows, nCols, numEntries);
+    int entry = 0;
+    for (int r = 0; r < nRows; r++)
+    {
+        matrix->rowStarts[r] = entry;
+        int *columns = matrix->colIndices + entry;
+        int length = lengths[r];
+        if (length == nCols)
+        {
+            for (int j = 0; j < length; j++)
+            {
+                columns[j] = j;
+            }
+        }
+        else
+        {
+            // Random draws, sorted and deduplicated; rows with many
+            // collisions end up slightly shorter.
+            for (int j = 0; j < length; j++)
+            {
+                columns[j] = (int)(nextRandom(&state) % (unsigned int)nCols);
+            }
+            qsort(columns, length, sizeof(int), compareInts);
+            int distinct = 1;
+            for (int j = 1; j < length; j++)
+            {
+                if (columns[j] != columns[distinct - 1])
+                {
+                    columns[distinct++] = columns[j];
+                }
+            }
+            length = distinct;
+        }
+        for (int j = 0; j < length; j++)
+        {
+            int magnitude = 1 + (int)(nextRandom(&state) % 1000);
+            matrix->values[entry + j] = nextRandom(&state) & 1 ? magnitude : -magnitude;
+        }
+        entry += length;
+    }
+    matrix->rowStarts[nRows] = entry;
+    free(lengths);
+    return matrix;
+}
+
+typedef struct RowLength
+{
+    int row;
+    int length;
+} RowLength;
+
+static int compareLongestFirst(const void *a, const void *b)
+{
+    const RowLength *x = a;
+    const RowLength *y = b;
+    if (x->length != y->length)
+    {
+        return y->length - x->length;
+    }
+    return x->row - y->row;
+}
+
+SellMatrix *SellFromSparse(const SparseMatrix *matrix, int chunkHeight, int sortWindow)
+{
+    SellMatrix *sell = malloc(sizeof(SellMatrix));
+    sell->nRows = matrix->nRows;
+    sell->nCols = matrix->nCols;
+    sell->chunkHeight = chunkHeight;
+    sell->numChunks = (matrix->nRows + chunkHeight - 1) / chunkHeight;
+    sell->chunkStarts = malloc(sizeof(int) * (sell->numChunks + 1));
+    sell->chunkWidths = malloc(sizeof(int) * (sell->numChunks > 0 ? sell->numChunks : 1));
+    sell->rowOrder = malloc(sizeof(int) * ((size_t)sell->numChunks * chunkHeight + 1));
+
+    RowLength *order = malloc(sizeof(RowLength) * (matrix->nRows > 0 ? matrix->nRows : 1));
+    for (int r = 0; r < matrix->nRows; r++)
+    {
+        order[r] = (RowLength){.row = r, .length = matrix->rowStarts[r + 1] - matrix->rowStarts[r]};
+    }
+    for (int start = 0; start < matrix->nRows; start += sortWindow)
+    {
+        int count = matrix->nRows - start < sortWindow ? matrix->nRows - start : sortWindow;
+        qsort(order + start, count, sizeof(RowLength), compareLongestFirst);
+    }
+
+    long long numSlots = 0;
+    for (int c = 0; c < sell->numChunks; c++)
+    {
+        // A chunk is as wide as its longest row.
+        int width = 0;
+        for (int i = 0; i < chunkHeight; i++)
+        {
+            int position = c * chunkHeight + i;
+            sell->rowOrder[position] = position < matrix->nRows ? order[position].row : -1;
+            if (position < matrix->nRows && order[position].length > width)
+            {
+                width = order[position].length;
+            }
+        }
+        sell->chunkStarts[c] = (int)numSlots;
+        sell->chunkWidths[c] = width;
+        numSlots += (long long)width * chunkHeight;
+    }
+    sell->chunkStarts[sell->numChunks] = (int)numSlots;
+    free(order);
+
+    sell->colIndices = AllocatePages(sizeof(int) * (numSlots > 0 ? numSlots : 1));
+    sell->values = AllocatePages(sizeof(int) * (numSlots > 0 ? numSlots : 1));
+    for (int c = 0; c < sell->numChunks; c++)
+    {
+        for (int i = 0; i < chunkHeight; i++)
+        {
+            int row = sell->rowOrder[c * chunkHeight + i];
+            int start = row >= 0 ? matrix->rowStarts[row] : 0;
+            int length = row >= 0 ? matrix->rowStarts[row + 1] - start : 0;
+            for (int j = 0; j < sell->chunkWidths[c]; j++)
+            {
+                int slot = sell->chunkStarts[c] + j * chunkHeight + i;
+                sell->colIndices[slot] = j < length ? matrix->colIndices[start + j] : 0;
+                sell->values[slot] = j < length ? matrix->values[start + j] : 0;
+            }
+        }
+    }
+    return sell;
+}
+
+long long GetSparseNonZeros(const SparseMatrix *matrix)
+{
+    return matrix->rowStarts[matrix->nRows];
+}
+
+void FreeSparseMatrix(SparseMatrix *matrix)
+{
+    free(matrix->rowStarts);
+    FreePages(matrix->colIndices);
+    FreePages(matrix->values);
+    free(matrix);
+}
+
+void FreeSellMatrix(SellMatrix *matrix)
+{
+    free(matrix->chunkStarts);
+    free(matrix->chunkWidths);
+    free(matrix->rowOrder);
+    FreePages(matrix->colIndices);
+    FreePages(matrix->values);
+    free(matrix);
+}
@@ -0,0 +1,66 @@
+#ifndef OPENMP_SPARSE_MATRIX_H
+#define OPENMP_SPARSE_MATRIX_H
+#endif
+
+/*
+ * Compressed sparse rows: the entries of row r are
+ * [rowStarts[r], rowStarts[r + 1]) in colIndices and values, in ascending
+ * column order unless the matrix was read from a file.
+ */
+typedef struct
+{
+    int nRows, nCols;
+    int *rowStarts;
+    int *colIndices;
+    int *values;
+} SparseMatrix;
+
+/*
+ * SELL-C-sigma: rows are sorted by length, longest first, within windows
+ * of sortWindow rows and cut into chunks of chunkHeight rows. A chunk is
+ * padded to its longest row and stored column by column, so entry j of
+ * chunk row i is at chunkStarts[chunk] + j * chunkHeight + i. Padding has
+ * value 0 and column 0. rowOrder maps chunk rows back to matrix rows, -1
+ * past the last row.
+ */
+typedef struct
+{
+    int nRows, nCols;
+    int chunkHeight;
+    int numChunks;
+    int *chunkStarts;
+    int *chunkWidths;
+    int *rowOrder;
+    int *colIndices;
+    int *values;
+} SellMatrix;
+
+// Stores the non-zero elements of matrix; include matrix.h first.
+SparseMatrix *SparseFromMatrix(Matrix *matrix);
+
+/*
+ * Reads a Matrix Market coordinate file ("%%MatrixMarket matrix coordinate
+ * integer|real|pattern general|symmetric"). Real values are rounded,
+ * pattern entries are 1, symmetric files are expanded and duplicate
+ * entries are kept as they are. Returns NULL with a message on error.
+ */
+SparseMatrix *ReadSparseCoordinates(const char *path);
+
+// Reads only the dimensions line of a coordinate file; returns 0 on success.
+int ReadSparseCoordinatesSize(const char *path, int *nRows, int *nCols);
+
+/*
+ * Random matrix with row lengths drawn from a Pareto distribution with the
+ * given alpha and mean, capped at nCols, distinct random columns and
+ * non-zero values in [-1000, 1000]. alpha <= 1 gives every row meanRowLength
+ * entries. The seed is fixed, so equal arguments give equal matrices.
+ */
+SparseMatrix *InitPowerLawSparse(int nRows, int nCols, int meanRowLength, double alpha);
+
+SellMatrix *SellFromSparse(const SparseMatrix *matrix, int chunkHeight, int sortWindow);
+
+long long GetSparseNonZeros(const SparseMatrix *matrix);
+
+void FreeSparseMatrix(SparseMatrix *matrix);
+
+void FreeSellMatrix(SellMatrix *matrix);
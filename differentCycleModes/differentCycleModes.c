@@ -1,6 +1,9 @@
 
 #include "differentCycleModes.h"
 #include "../utils/utils.h"
+#include "../workloads/workloads.h"
+#include "../benchmark/registry.h"
+#include "../benchmark/loadBalance.h"
 #include "limits.h"
 #include "omp.h"
 #include "math.h"
@@ -33,11 +36,17 @@ static int plainForLoop(int numIterations)
 static int staticScheduledForLoop(int numIterations)
 {
     int sumMod = 0;
-#pragma omp parallel for shared(numIterations) schedule(static) reduction(+ \
-                                                                          : sumMod)
-    for (int i = 0; i < numIterations; i++)
+#pragma omp parallel shared(numIterations) reduction(+ \
+                                                     : sumMod)
     {
-        sumMod += testIteration(i) % 100;
+        LOAD_BALANCE_THREAD_BEGIN();
+#pragma omp for schedule(static) nowait
+        for (int i = 0; i < numIterations; i++)
+        {
+            LOAD_BALANCE_ITERATION();
+            sumMod += testIteration(i) % 100;
+        }
+        LOAD_BALANCE_THREAD_END();
     }
     return sumMod;
 }
@@ -45,12 +54,17 @@ static int staticScheduledForLoop(int numIterations)
 static int dynamicScheduledForLoop(int numIterations)
 {
     int sumMod = 0;
-#pragma omp parallel for shared(numIterations) schedule(dynamic, 8) reduction(+ \
-                                                                              : sumMod)
-
-    for (int i = 0; i < numIterations; i++)
+#pragma omp parallel shared(numIterations) reduction(+ \
+                                                     : sumMod)
     {
-        sumMod += testIteration(i) % 100;
+        LOAD_BALANCE_THREAD_BEGIN();
+#pragma omp for schedule(dynamic, 8) nowait
+        for (int i = 0; i < numIterations; i++)
+        {
+            LOAD_BALANCE_ITERATION();
+            sumMod += testIteration(i) % 100;
+        }
+        LOAD_BALANCE_THREAD_END();
     }
     return sumMod;
 }
@@ -58,11 +72,17 @@ static int dynamicScheduledForLoop(int numIterations)
 static int guidedScheduledForLoop(int numIterations)
 {
     int sumMod = 0;
-#pragma omp parallel for shared(numIterations) schedule(guided) reduction(+ \
-                                                                          : sumMod)
-    for (int i = 0; i < numIterations; i++)
+#pragma omp parallel shared(numIterations) reduction(+ \
+                                                     : sumMod)
     {
-        sumMod += testIteration(i) % 100;
+        LOAD_BALANCE_THREAD_BEGIN();
+#pragma omp for schedule(guided) nowait
+        for (int i = 0; i < numIterations; i++)
+        {
+            LOAD_BALANCE_ITERATION();
+            sumMod += testIteration(i) % 100;
+        }
+        LOAD_BALANCE_THREAD_END();
     }
     return sumMod;
 }
@@ -107,4 +127,336 @@ int PerformDifferentCycleModesComparison()
     }
     fclose(f);
     return 0;
-}
\ No newline at end of file
+}
+
+static int workloadSingleThread(Workload *workload)
+{
+    int checksum = 0;
+    for (int i = 0; i < workload->numIterations; i++)
+    {
+        checksum += RunWorkloadIteration(workload, i);
+    }
+    return checksum;
+}
+
+static int workloadStaticBlock(Workload *workload)
+{
+    int checksum = 0;
+#pragma omp parallel shared(workload) reduction(+ \
+                                                : checksum)
+    {
+        LOAD_BALANCE_THREAD_BEGIN();
+#pragma omp for schedule(static) nowait
+        for (int i = 0; i < workload->numIterations; i++)
+        {
+            LOAD_BALANCE_ITERATION();
+            checksum += RunWorkloadIteration(workload, i);
+        }
+        LOAD_BALANCE_THREAD_END();
+    }
+    return checksum;
+}
+
+static int workloadRuntimeScheduled(Workload *workload)
+{
+    int checksum = 0;
+#pragma omp parallel shared(workload) reduction(+ \
+                                                : checksum)
+    {
+        LOAD_BALANCE_THREAD_BEGIN();
+#pragma omp for schedule(runtime) nowait
+        for (int i = 0; i < workload->numIterations; i++)
+        {
+            LOAD_BALANCE_ITERATION();
+            checksum += RunWorkloadIteration(workload, i);
+        }
+        LOAD_BALANCE_THREAD_END();
+    }
+    return checksum;
+}
+
+static int findIterationByCost(Workload *workload, long long cost)
+{
+    int low = 0;
+    int high = workload->numIterations;
+    while (low < high)
+    {
+        int middle = low + (high - low) / 2;
+        if (workload->prefixCosts[middle] < cost)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+static int workloadCostBalanced(Workload *workload)
+{
+    int checksum = 0;
+#pragma omp parallel shared(workload) reduction(+ \
+                                                : checksum)
+    {
+        int numThreads = omp_get_num_threads();
+        int threadNum = omp_get_thread_num();
+        int start = findIterationByCost(workload, workload->totalCost * threadNum / numThreads);
+        int end = findIterationByCost(workload, workload->totalCost * (threadNum + 1) / numThreads);
+        LOAD_BALANCE_THREAD_BEGIN();
+        for (int i = start; i < end; i++)
+        {
+            LOAD_BALANCE_ITERATION();
+            checksum += RunWorkloadIteration(workload, i);
+        }
+        LOAD_BALANCE_THREAD_END();
+    }
+    return checksum;
+}
+
+static double measureWorkload(int (*method)(Workload *), Workload *workload)
+{
+    double start = omp_get_wtime();
+    method(workload);
+    double end = omp_get_wtime();
+    return (end - start) * 1000;
+}
+
+typedef struct ScheduleVariant
+{
+    const char *name;
+    int (*method)(Workload *);
+    omp_sched_t kind;
+    int chunkSize;
+} ScheduleVariant;
+
+static const ScheduleVariant scheduleVariants[] = {
+    {"static", workloadStaticBlock, omp_sched_static, 0},
+    {"static_1", workloadRuntimeScheduled, omp_sched_static, 1},
+    {"dynamic_1", workloadRuntimeScheduled, omp_sched_dynamic, 1},
+    {"dynamic_8", workloadRuntimeScheduled, omp_sched_dynamic, 8},
+    {"dynamic_64", workloadRuntimeScheduled, omp_sched_dynamic, 64},
+    {"guided", workloadRuntimeScheduled, omp_sched_guided, 1},
+    {"cost_balanced", workloadCostBalanced, omp_sched_static, 0},
+};
+
+static void doWorkloadTestCycle(Workload *workload, FILE *file)
+{
+    const char *profile = GetCostProfileName(workload->profile);
+    const char *body = GetBodyKindName(workload->body);
+    double serialTime = measureWorkload(workloadSingleThread, workload);
+    double timePerUnit = serialTime / workload->totalCost;
+    fprintf(file, "1;single;%s;%s;%d;%.20f;%.20f;%.6f\n", profile, body,
+            workload->numIterations, serialTime, serialTime, 1.0);
+
+    const int numVariants = sizeof(scheduleVariants) / sizeof(scheduleVariants[0]);
+    const int maxNumThreads = omp_get_num_procs() * 2;
+    for (int numThreads = 2; numThreads <= maxNumThreads; numThreads += 1)
+    {
+        omp_set_num_threads(numThreads);
+        double idealCost = (double)workload->totalCost / numThreads;
+        double idealTime = fmax(idealCost, workload->maxCost) * timePerUnit;
+        for (int v = 0; v < numVariants; v++)
+        {
+            omp_set_schedule(scheduleVariants[v].kind, scheduleVariants[v].chunkSize);
+            double elapsed = measureWorkload(scheduleVariants[v].method, workload);
+            fprintf(file, "%d;%s;%s;%s;%d;%.20f;%.20f;%.6f\n", numThreads, scheduleVariants[v].name,
+                    profile, body, workload->numIterations, elapsed, idealTime, idealTime / elapsed);
+        }
+    }
+}
+
+int PerformWorkloadSchedulesComparison()
+{
+    FILE *f = fopen("../python_scripts/differentCycleModes/workloads.csv", "w+");
+    fprintf(f, "num_threads;method;profile;body;num_iterations;elapsed_time;ideal_time;efficiency\n");
+
+    const CostProfile profiles[] = {COST_UNIFORM, COST_INCREASING, COST_PARETO, COST_BIMODAL};
+    const double shapes[] = {0, 0, 1.5, 0.1};
+    const BodyKind bodies[] = {BODY_COMPUTE, BODY_MEMORY};
+    for (int b = 0; b < 2; b++)
+    {
+        for (int p = 0; p < 4; p++)
+        {
+            Workload *workload = InitWorkload(profiles[p], bodies[b], 100000, 100, shapes[p]);
+            for (int i = 0; i < 15; i++)
+            {
+                doWorkloadTestCycle(workload, f);
+            }
+            FreeWorkload(workload);
+        }
+    }
+    fclose(f);
+    return 0;
+}
+
+static void *setupCycleModes(int size, const void *parameters)
+{
+    int *numIterations = malloc(sizeof(int));
+    *numIterations = size;
+    return numIterations;
+}
+
+static void teardownCycleModes(void *input)
+{
+    free(input);
+}
+
+static double runPlainForLoop(void *input)
+{
+    return plainForLoop(*(int *)input);
+}
+
+static double runStaticScheduledForLoop(void *input)
+{
+    return staticScheduledForLoop(*(int *)input);
+}
+
+static double runDynamicScheduledForLoop(void *input)
+{
+    return dynamicScheduledForLoop(*(int *)input);
+}
+
+static double runGuidedScheduledForLoop(void *input)
+{
+    return guidedScheduledForLoop(*(int *)input);
+}
+
+typedef struct WorkloadParameters
+{
+    CostProfile profile;
+    BodyKind body;
+    double shape;
+} WorkloadParameters;
+
+static void *setupWorkload(int size, const void *parameters)
+{
+    const WorkloadParameters *workload = parameters;
+    return InitWorkload(workload->profile, workload->body, size, 100, workload->shape);
+}
+
+static void teardownWorkload(void *input)
+{
+    FreeWorkload(input);
+}
+
+static double runWorkloadSingleThread(void *input)
+{
+    return workloadSingleThread(input);
+}
+
+static double runWorkloadStatic(void *input)
+{
+    return workloadStaticBlock(input);
+}
+
+static double runWorkloadScheduled(void *input, omp_sched_t kind, int chunkSize)
+{
+    omp_set_schedule(kind, chunkSize);
+    return workloadRuntimeScheduled(input);
+}
+
+static double runWorkloadStaticCyclic(void *input)
+{
+    return runWorkloadScheduled(input, omp_sched_static, 1);
+}
+
+static double runWorkloadDynamic1(void *input)
+{
+    return runWorkloadScheduled(input, omp_sched_dynamic, 1);
+}
+
+static double runWorkloadDynamic8(void *input)
+{
+    return runWorkloadScheduled(input, omp_sched_dynamic, 8);
+}
+
+static double runWorkloadDynamic64(void *input)
+{
+    return runWorkloadScheduled(input, omp_sched_dynamic, 64);
+}
+
+static double runWorkloadGuided(void *input)
+{
+    return runWorkloadScheduled(input, omp_sched_guided, 1);
+}
+
+static double runWorkloadCostBalanced(void *input)
+{
+    return workloadCostBalanced(input);
+}
+
+// testIteration: one random draw every tenth iteration, otherwise
+// number % 100 add/modulo pairs; the outer modulo and add are not counted.
+static BenchmarkWork workCycleModes(const void *input)
+{
+    const int numIterations = *(const int *)input;
+    double operations = 0;
+    for (int i = 0; i < numIterations; i++)
+    {
+        operations += i % 10 == 0 ? 1 : 2 * (i % 100);
+    }
+    return (BenchmarkWork){.bytes = 0, .operations = operations};
+}
+
+// A compute unit is two multiply-adds; a memory unit two dependent loads
+// from a buffer far larger than the caches, counted as their int payload.
+static BenchmarkWork workWorkload(const void *input)
+{
+    const Workload *workload = input;
+    if (workload->body == BODY_MEMORY)
+    {
+        return (BenchmarkWork){.bytes = 2.0 * sizeof(int) * workload->totalCost, .operations = 3.0 * workload->totalCost};
+    }
+    return (BenchmarkWork){.bytes = 0, .operations = 4.0 * workload->totalCost};
+}
+
+static const WorkloadParameters registeredWorkloads[] = {
+    {COST_UNIFORM, BODY_COMPUTE, 0},
+    {COST_INCREASING, BODY_COMPUTE, 0},
+    {COST_PARETO, BODY_COMPUTE, 1.5},
+    {COST_BIMODAL, BODY_COMPUTE, 0.1},
+    {COST_UNIFORM, BODY_MEMORY, 0},
+    {COST_INCREASING, BODY_MEMORY, 0},
+    {COST_PARETO, BODY_MEMORY, 1.5},
+    {COST_BIMODAL, BODY_MEMORY, 0.1},
+};
+static char registeredWorkloadNames[8][64];
+
+void RegisterDifferentCycleModesBenchmarks()
+{
+    const BenchmarkGroup *group = RegisterBenchmarkGroup((BenchmarkGroup){
+        .name = "differentCycleModes",
+        .setup = setupCycleModes,
+        .teardown = teardownCycleModes,
+        .work = workCycleModes,
+        .numDefaultSizes = 3,
+        .defaultSizes = {100, 10000, 1000000}});
+    RegisterBenchmark(group, "single", runPlainForLoop, 0);
+    RegisterBenchmark(group, "static", runStaticScheduledForLoop, 1);
+    RegisterBenchmark(group, "dynamic", runDynamicScheduledForLoop, 1);
+    RegisterBenchmark(group, "guided", runGuidedScheduledForLoop, 1);
+
+    for (int w = 0; w < 8; w++)
+    {
+        snprintf(registeredWorkloadNames[w], sizeof(registeredWorkloadNames[w]), "workload_%s_%s",
+                 GetCostProfileName(registeredWorkloads[w].profile), GetBodyKindName(registeredWorkloads[w].body));
+        group = RegisterBenchmarkGroup((BenchmarkGroup){
+            .name = registeredWorkloadNames[w],
+            .setup = setupWorkload,
+            .teardown = teardownWorkload,
+            .work = workWorkload,
+            .parameters = &registeredWorkloads[w],
+            .numDefaultSizes = 1,
+            .defaultSizes = {100000}});
+        RegisterBenchmark(group, "single", runWorkloadSingleThread, 0);
+        RegisterBenchmark(group, "static", runWorkloadStatic, 1);
+        RegisterBenchmark(group, "static_1", runWorkloadStaticCyclic, 1);
+        RegisterBenchmark(group, "dynamic_1", runWorkloadDynamic1, 1);
+        RegisterBenchmark(group, "dynamic_8", runWorkloadDynamic8, 1);
+        RegisterBenchmark(group, "dynamic_64", runWorkloadDynamic64, 1);
+        RegisterBenchmark(group, "guided", runWorkloadGuided, 1);
+        RegisterBenchmark(group, "cost_balanced", runWorkloadCostBalanced, 1);
+    }
+}
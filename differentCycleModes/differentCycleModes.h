@@ -1,2 +1,6 @@
 
-int PerformDifferentCycleModesComparison();
\ No newline at end of file
+int PerformDifferentCycleModesComparison();
+
+int PerformWorkloadSchedulesComparison();
+
+void RegisterDifferentCycleModesBenchmarks();
@@ -3,6 +3,8 @@
 #include "malloc.h"
 #include "omp.h"
 #include "stdlib.h"
+#include "../benchmark/registry.h"
+#include "../datatypes/hugePages.h"
 
 int dotProductSingleThread(int *a, int *b, int sizeA, int sizeB)
 {
@@ -108,8 +110,8 @@ double measureDotProduct(int (*method)(int *, int *, int, int), int *vectorA, in
 
 void doDotProductTestCycle(int arraySize, FILE *file)
 {
-    int *firstArray = malloc(sizeof(int) * arraySize);
-    int *secondArray = malloc(sizeof(int) * arraySize);
+    int *firstArray = AllocatePages(sizeof(int) * arraySize);
+    int *secondArray = AllocatePages(sizeof(int) * arraySize);
     FillWithRandomValues(arraySize, firstArray);
     FillWithRandomValues(arraySize, secondArray);
 
@@ -127,8 +129,8 @@ void doDotProductTestCycle(int arraySize, FILE *file)
                 measureDotProduct(dotProductWithReduction, firstArray, secondArray, arraySize, arraySize));
     }
 
-    free(firstArray);
-    free(secondArray);
+    FreePages(firstArray);
+    FreePages(secondArray);
 }
 
 int PerformDotProductComparison()
@@ -143,4 +145,75 @@ int PerformDotProductComparison()
     }
     fclose(f);
     return 0;
-}
\ No newline at end of file
+}
+
+typedef struct DotProductInput
+{
+    int *a;
+    int *b;
+    int size;
+} DotProductInput;
+
+static void *setupDotProduct(int size, const void *parameters)
+{
+    DotProductInput *input = malloc(sizeof(DotProductInput));
+    input->a = AllocatePages(sizeof(int) * size);
+    input->b = AllocatePages(sizeof(int) * size);
+    input->size = size;
+    FillWithRandomValues(size, input->a);
+    FillWithRandomValues(size, input->b);
+    return input;
+}
+
+static void teardownDotProduct(void *input)
+{
+    DotProductInput *vectors = input;
+    FreePages(vectors->a);
+    FreePages(vectors->b);
+    free(vectors);
+}
+
+static double runDotProductSingleThread(void *input)
+{
+    DotProductInput *v = input;
+    return dotProductSingleThread(v->a, v->b, v->size, v->size);
+}
+
+static double runDotProductWithCriticalSection(void *input)
+{
+    DotProductInput *v = input;
+    return dotProductWithCriticalSection(v->a, v->b, v->size, v->size);
+}
+
+static double runDotProductWithAtomic(void *input)
+{
+    DotProductInput *v = input;
+    return dotProductWithAtomic(v->a, v->b, v->size, v->size);
+}
+
+static double runDotProductWithReduction(void *input)
+{
+    DotProductInput *v = input;
+    return dotProductWithReduction(v->a, v->b, v->size, v->size);
+}
+
+static BenchmarkWork workDotProduct(const void *input)
+{
+    const DotProductInput *v = input;
+    return (BenchmarkWork){.bytes = 2.0 * sizeof(int) * v->size, .operations = 2.0 * v->size};
+}
+
+void RegisterDotProductBenchmarks()
+{
+    const BenchmarkGroup *group = RegisterBenchmarkGroup((BenchmarkGroup){
+        .name = "dotProduct",
+        .setup = setupDotProduct,
+        .teardown = teardownDotProduct,
+        .work = workDotProduct,
+        .numDefaultSizes = 3,
+        .defaultSizes = {100, 100000, 100000000}});
+    RegisterBenchmark(group, "single", runDotProductSingleThread, 0);
+    RegisterBenchmark(group, "critical_section", runDotProductWithCriticalSection, 1);
+    RegisterBenchmark(group, "atomic", runDotProductWithAtomic, 1);
+    RegisterBenchmark(group, "reduction", runDotProductWithReduction, 1);
+}
@@ -4,4 +4,8 @@
 
 #include "../utils/utils.h"
 
-int PerformDotProductComparison();
\ No newline at end of file
+int dotProductWithReduction(int *a, int *b, int sizeA, int sizeB);
+
+int PerformDotProductComparison();
+
+void RegisterDotProductBenchmarks();
@@ -4,6 +4,7 @@
 #include "omp.h"
 #include "stdlib.h"
 #include "math.h"
+#include "../benchmark/registry.h"
 
 static double integrateInSingleThread(double (*function)(double x), double leftBorder, double rightBorder, int numRects)
 {
@@ -93,6 +94,11 @@ static double integrateWithReduction(double (*function)(double x), double leftBo
     return result * h;
 }
 
+double IntegrateWithReduction(double (*function)(double x), double leftBorder, double rightBorder, int numRects)
+{
+    return integrateWithReduction(function, leftBorder, rightBorder, numRects);
+}
+
 typedef struct MeasurmentResult
 {
     double returnValue;
@@ -160,4 +166,57 @@ int PerformIntegralComputationComparison()
     fclose(errPath);
     fclose(f);
     return 0;
-}
\ No newline at end of file
+}
+
+static void *setupIntegral(int size, const void *parameters)
+{
+    int *numRects = malloc(sizeof(int));
+    *numRects = size;
+    return numRects;
+}
+
+static void teardownIntegral(void *input)
+{
+    free(input);
+}
+
+static double runIntegrateInSingleThread(void *input)
+{
+    return integrateInSingleThread(exp, 0, 100, *(int *)input);
+}
+
+static double runIntegrateWithCriticalSection(void *input)
+{
+    return integrateWithCriticalSection(exp, 0, 100, *(int *)input);
+}
+
+static double runIntegrateWithAtomic(void *input)
+{
+    return integrateWithAtomic(exp, 0, 100, *(int *)input);
+}
+
+static double runIntegrateWithReduction(void *input)
+{
+    return integrateWithReduction(exp, 0, 100, *(int *)input);
+}
+
+// Midpoint (multiply, two adds), exp counted as one operation, accumulate.
+static BenchmarkWork workIntegral(const void *input)
+{
+    return (BenchmarkWork){.bytes = 0, .operations = 5.0 * *(const int *)input};
+}
+
+void RegisterIntegralBenchmarks()
+{
+    const BenchmarkGroup *group = RegisterBenchmarkGroup((BenchmarkGroup){
+        .name = "integrals",
+        .setup = setupIntegral,
+        .teardown = teardownIntegral,
+        .work = workIntegral,
+        .numDefaultSizes = 3,
+        .defaultSizes = {100, 10000, 1000000}});
+    RegisterBenchmark(group, "single", runIntegrateInSingleThread, 0);
+    RegisterBenchmark(group, "critical_section", runIntegrateWithCriticalSection, 1);
+    RegisterBenchmark(group, "atomic", runIntegrateWithAtomic, 1);
+    RegisterBenchmark(group, "reduction", runIntegrateWithReduction, 1);
+}
@@ -3,4 +3,9 @@
 #endif 
 
 
-int PerformIntegralComputationComparison();
\ No newline at end of file
+// Midpoint rule with numRects rectangles and an OpenMP reduction.
+double IntegrateWithReduction(double (*function)(double x), double leftBorder, double rightBorder, int numRects);
+
+int PerformIntegralComputationComparison();
+
+void RegisterIntegralBenchmarks();
@@ -0,0 +1,437 @@
+#include "spinlocks.h"
+#include "omp.h"
+#include "malloc.h"
+#include "stdio.h"
+#include "../benchmark/registry.h"
+
+#define CACHE_LINE_SIZE 64
+#define TTAS_MIN_BACKOFF 4
+#define TTAS_MAX_BACKOFF 1024
+#define SHARED_DATA_SIZE 16
+
+typedef struct QueueNode
+{
+    struct QueueNode *next;
+    int locked;
+} __attribute__((aligned(CACHE_LINE_SIZE))) QueueNode;
+
+typedef struct PaddedPointer
+{
+    QueueNode *node;
+} __attribute__((aligned(CACHE_LINE_SIZE))) PaddedPointer;
+
+struct SpinLock
+{
+    LockKind kind;
+    int maxThreads;
+    omp_lock_t ompLock;
+    int flag __attribute__((aligned(CACHE_LINE_SIZE)));
+    unsigned int nextTicket __attribute__((aligned(CACHE_LINE_SIZE)));
+    unsigned int nowServing __attribute__((aligned(CACHE_LINE_SIZE)));
+    QueueNode *tail __attribute__((aligned(CACHE_LINE_SIZE)));
+    QueueNode *nodes;
+    PaddedPointer *myNode;
+    PaddedPointer *myPred;
+};
+
+static inline void cpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+SpinLock *InitSpinLock(LockKind kind, int maxThreads)
+{
+    SpinLock *lock = memalign(CACHE_LINE_SIZE, sizeof(SpinLock));
+    lock->kind = kind;
+    lock->maxThreads = maxThreads;
+    lock->flag = 0;
+    lock->nextTicket = 0;
+    lock->nowServing = 0;
+    lock->tail = NULL;
+    lock->nodes = NULL;
+    lock->myNode = NULL;
+    lock->myPred = NULL;
+
+    switch (kind)
+    {
+    case LOCK_OMP:
+        omp_init_lock(&lock->ompLock);
+        break;
+    case LOCK_MCS:
+        lock->nodes = memalign(CACHE_LINE_SIZE, sizeof(QueueNode) * maxThreads);
+        break;
+    case LOCK_CLH:
+        // One spare node serves as the initial released tail; nodes then
+        // migrate between threads as each one recycles its predecessor's.
+        lock->nodes = memalign(CACHE_LINE_SIZE, sizeof(QueueNode) * (maxThreads + 1));
+        lock->myNode = memalign(CACHE_LINE_SIZE, sizeof(PaddedPointer) * maxThreads);
+        lock->myPred = memalign(CACHE_LINE_SIZE, sizeof(PaddedPointer) * maxThreads);
+        for (int i = 0; i < maxThreads; i++)
+        {
+            lock->myNode[i].node = &lock->nodes[i];
+            lock->myPred[i].node = NULL;
+        }
+        lock->nodes[maxThreads].locked = 0;
+        lock->tail = &lock->nodes[maxThreads];
+        break;
+    default:
+        break;
+    }
+    return lock;
+}
+
+static void acquireTTAS(SpinLock *lock)
+{
+    int backoff = TTAS_MIN_BACKOFF;
+    for (;;)
+    {
+        while (__atomic_load_n(&lock->flag, __ATOMIC_RELAXED))
+        {
+            cpuRelax();
+        }
+        if (!__atomic_exchange_n(&lock->flag, 1, __ATOMIC_ACQUIRE))
+        {
+            return;
+        }
+        for (int i = 0; i < backoff; i++)
+        {
+            cpuRelax();
+        }
+        if (backoff < TTAS_MAX_BACKOFF)
+        {
+            backoff *= 2;
+        }
+    }
+}
+
+static void acquireTicket(SpinLock *lock)
+{
+    unsigned int ticket = __atomic_fetch_add(&lock->nextTicket, 1, __ATOMIC_RELAXED);
+    unsigned int serving;
+    while ((serving = __atomic_load_n(&lock->nowServing, __ATOMIC_ACQUIRE)) != ticket)
+    {
+        // Proportional backoff: wait longer the further back in the queue we are.
+        for (unsigned int i = 0; i < (ticket - serving) * TTAS_MIN_BACKOFF; i++)
+        {
+            cpuRelax();
+        }
+    }
+}
+
+static void acquireMCS(SpinLock *lock, int threadNum)
+{
+    QueueNode *node = &lock->nodes[threadNum];
+    node->next = NULL;
+    node->locked = 1;
+    QueueNode *pred = __atomic_exchange_n(&lock->tail, node, __ATOMIC_ACQ_REL);
+    if (pred == NULL)
+    {
+        return;
+    }
+    __atomic_store_n(&pred->next, node, __ATOMIC_RELEASE);
+    while (__atomic_load_n(&node->locked, __ATOMIC_ACQUIRE))
+    {
+        cpuRelax();
+    }
+}
+
+static void releaseMCS(SpinLock *lock, int threadNum)
+{
+    QueueNode *node = &lock->nodes[threadNum];
+    QueueNode *succ = __atomic_load_n(&node->next, __ATOMIC_ACQUIRE);
+    if (succ == NULL)
+    {
+        QueueNode *expected = node;
+        if (__atomic_compare_exchange_n(&lock->tail, &expected, NULL, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+        {
+            return;
+        }
+        // A successor swapped the tail but has not linked itself yet.
+        while ((succ = __atomic_load_n(&node->next, __ATOMIC_ACQUIRE)) == NULL)
+        {
+            cpuRelax();
+        }
+    }
+    __atomic_store_n(&succ->locked, 0, __ATOMIC_RELEASE);
+}
+
+static void acquireCLH(SpinLock *lock, int threadNum)
+{
+    QueueNode *node = lock->myNode[threadNum].node;
+    __atomic_store_n(&node->locked, 1, __ATOMIC_RELAXED);
+    QueueNode *pred = __atomic_exchange_n(&lock->tail, node, __ATOMIC_ACQ_REL);
+    lock->myPred[threadNum].node = pred;
+    while (__atomic_load_n(&pred->locked, __ATOMIC_ACQUIRE))
+    {
+        cpuRelax();
+    }
+}
+
+static void releaseCLH(SpinLock *lock, int threadNum)
+{
+    QueueNode *node = lock->myNode[threadNum].node;
+    __atomic_store_n(&node->locked, 0, __ATOMIC_RELEASE);
+    lock->myNode[threadNum].node = lock->myPred[threadNum].node;
+}
+
+void AcquireSpinLock(SpinLock *lock, int threadNum)
+{
+    switch (lock->kind)
+    {
+    case LOCK_OMP:
+        omp_set_lock(&lock->ompLock);
+        break;
+    case LOCK_TTAS:
+        acquireTTAS(lock);
+        break;
+    case LOCK_TICKET:
+        acquireTicket(lock);
+        break;
+    case LOCK_MCS:
+        acquireMCS(lock, threadNum);
+        break;
+    case LOCK_CLH:
+        acquireCLH(lock, threadNum);
+        break;
+    default:
+        break;
+    }
+}
+
+void ReleaseSpinLock(SpinLock *lock, int threadNum)
+{
+    switch (lock->kind)
+    {
+    case LOCK_OMP:
+        omp_unset_lock(&lock->ompLock);
+        break;
+    case LOCK_TTAS:
+        __atomic_store_n(&lock->flag, 0, __ATOMIC_RELEASE);
+        break;
+    case LOCK_TICKET:
+        __atomic_store_n(&lock->nowServing, lock->nowServing + 1, __ATOMIC_RELEASE);
+        break;
+    case LOCK_MCS:
+        releaseMCS(lock, threadNum);
+        break;
+    case LOCK_CLH:
+        releaseCLH(lock, threadNum);
+        break;
+    default:
+        break;
+    }
+}
+
+void FreeSpinLock(SpinLock *lock)
+{
+    if (lock->kind == LOCK_OMP)
+    {
+        omp_destroy_lock(&lock->ompLock);
+    }
+    free(lock->nodes);
+    free(lock->myNode);
+    free(lock->myPred);
+    free(lock);
+}
+
+const char *GetLockKindName(LockKind kind)
+{
+    switch (kind)
+    {
+    case LOCK_OMP:
+        return "omp";
+    case LOCK_TTAS:
+        return "ttas";
+    case LOCK_TICKET:
+        return "ticket";
+    case LOCK_MCS:
+        return "mcs";
+    case LOCK_CLH:
+        return "clh";
+    default:
+        return "unknown";
+    }
+}
+
+/*
+ * Every thread performs numAcquisitions lock/unlock pairs. Inside the lock
+ * it counts the acquisition in sharedData[0] and touches criticalLength - 1
+ * more shared words; outside it spins for delayLength iterations, which sets
+ * the acquisition rate. Returns the number of lost updates, which must be
+ * zero for a correct lock.
+ */
+static long long runContention(SpinLock *lock, int numAcquisitions, int criticalLength, int delayLength)
+{
+    long long sharedData[SHARED_DATA_SIZE] = {0};
+    int numThreads = 1;
+#pragma omp parallel shared(lock, numAcquisitions, criticalLength, delayLength, sharedData, numThreads) default(none)
+    {
+        int threadNum = omp_get_thread_num();
+        volatile int local = 0;
+        for (int n = 0; n < numAcquisitions; n++)
+        {
+            AcquireSpinLock(lock, threadNum);
+            sharedData[0]++;
+            for (int k = 1; k < criticalLength; k++)
+            {
+                sharedData[1 + k % (SHARED_DATA_SIZE - 1)]++;
+            }
+            ReleaseSpinLock(lock, threadNum);
+            for (int k = 0; k < delayLength; k++)
+            {
+                local++;
+            }
+        }
+        if (threadNum == 0)
+        {
+            numThreads = omp_get_num_threads();
+        }
+    }
+    return (long long)numThreads * numAcquisitions - sharedData[0];
+}
+
+static void doLockTestCycle(int criticalLength, int delayLength, int numAcquisitions, FILE *file, FILE *errPath)
+{
+    // Spinning waiters on oversubscribed cores only measure the OS scheduler,
+    // so the sweep stops at the number of processors.
+    const int maxNumThreads = omp_get_num_procs();
+    for (int numThreads = 1; numThreads <= maxNumThreads; numThreads++)
+    {
+        omp_set_num_threads(numThreads);
+        for (LockKind kind = 0; kind < LOCK_KIND_COUNT; kind++)
+        {
+            SpinLock *lock = InitSpinLock(kind, numThreads);
+            double start = omp_get_wtime();
+            long long lostUpdates = runContention(lock, numAcquisitions, criticalLength, delayLength);
+            double end = omp_get_wtime();
+            FreeSpinLock(lock);
+
+            fprintf(file, "%s;%d;%d;%d;%d;%.20f\n", GetLockKindName(kind), numThreads, criticalLength,
+                    delayLength, numAcquisitions, (end - start) * 1000);
+            if (lostUpdates != 0)
+            {
+                fprintf(errPath, "lock = %s, threads = %d, lost %lld updates\n",
+                        GetLockKindName(kind), numThreads, lostUpdates);
+            }
+        }
+    }
+}
+
+int PerformLockContentionComparison()
+{
+    FILE *f = fopen("../python_scripts/reductions/locks.csv", "w+");
+    FILE *errPath = fopen("errPath.txt", "w+");
+    fprintf(f, "lock;num_threads;critical_length;delay_length;acquisitions_per_thread;elapsed_time\n");
+
+    const int criticalLengths[] = {1, 16, 256};
+    const int delayLengths[] = {0, 64, 1024};
+    for (int i = 0; i < 15; i++)
+    {
+        for (int c = 0; c < 3; c++)
+        {
+            for (int d = 0; d < 3; d++)
+            {
+                doLockTestCycle(criticalLengths[c], delayLengths[d], 20000, f, errPath);
+            }
+        }
+    }
+    fclose(errPath);
+    fclose(f);
+    return 0;
+}
+
+typedef struct ContentionParameters
+{
+    int criticalLength;
+    int delayLength;
+} ContentionParameters;
+
+typedef struct ContentionInput
+{
+    int numAcquisitions;
+    ContentionParameters parameters;
+} ContentionInput;
+
+static void *setupContention(int size, const void *parameters)
+{
+    ContentionInput *input = malloc(sizeof(ContentionInput));
+    input->numAcquisitions = size;
+    input->parameters = *(const ContentionParameters *)parameters;
+    return input;
+}
+
+static void teardownContention(void *input)
+{
+    free(input);
+}
+
+static double runContentionWithLock(void *input, LockKind kind)
+{
+    ContentionInput *contention = input;
+    SpinLock *lock = InitSpinLock(kind, omp_get_max_threads());
+    long long lostUpdates = runContention(lock, contention->numAcquisitions,
+                                          contention->parameters.criticalLength, contention->parameters.delayLength);
+    FreeSpinLock(lock);
+    return lostUpdates;
+}
+
+static double runContentionOmp(void *input)
+{
+    return runContentionWithLock(input, LOCK_OMP);
+}
+
+static double runContentionTTAS(void *input)
+{
+    return runContentionWithLock(input, LOCK_TTAS);
+}
+
+static double runContentionTicket(void *input)
+{
+    return runContentionWithLock(input, LOCK_TICKET);
+}
+
+static double runContentionMCS(void *input)
+{
+    return runContentionWithLock(input, LOCK_MCS);
+}
+
+static double runContentionCLH(void *input)
+{
+    return runContentionWithLock(input, LOCK_CLH);
+}
+
+// One operation per lock handoff; every thread of the team, whose size is
+// already set when this is called, acquires numAcquisitions times.
+static BenchmarkWork workContention(const void *input)
+{
+    const ContentionInput *contention = input;
+    return (BenchmarkWork){.bytes = 0, .operations = (double)contention->numAcquisitions * omp_get_max_threads()};
+}
+
+static const ContentionParameters registeredContentions[] = {{1, 1024}, {16, 64}, {256, 0}};
+static const char *registeredContentionNames[] = {"lockContention_cs1_delay1024", "lockContention_cs16_delay64",
+                                                  "lockContention_cs256_delay0"};
+
+void RegisterLockContentionBenchmarks()
+{
+    for (int c = 0; c < 3; c++)
+    {
+        const BenchmarkGroup *group = RegisterBenchmarkGroup((BenchmarkGroup){
+            .name = registeredContentionNames[c],
+            .setup = setupContention,
+            .teardown = teardownContention,
+            .work = workContention,
+            .parameters = &registeredContentions[c],
+            .numDefaultSizes = 1,
+            .defaultSizes = {20000}});
+        RegisterBenchmark(group, "omp", runContentionOmp, 1);
+        RegisterBenchmark(group, "ttas", runContentionTTAS, 1);
+        RegisterBenchmark(group, "ticket", runContentionTicket, 1);
+        RegisterBenchmark(group, "mcs", runContentionMCS, 1);
+        RegisterBenchmark(group, "clh", runContentionCLH, 1);
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef OPENMP_SPINLOCKS_H
+#define OPENMP_SPINLOCKS_H
+#endif
+
+typedef enum LockKind
+{
+    LOCK_OMP,
+    LOCK_TTAS,
+    LOCK_TICKET,
+    LOCK_MCS,
+    LOCK_CLH,
+    LOCK_KIND_COUNT
+} LockKind;
+
+/*
+ * Mutual exclusion lock of a selectable kind. Queue locks (MCS, CLH) keep a
+ * node per thread, so callers pass their omp_get_thread_num() and the lock
+ * has to be created for at least omp_get_max_threads() threads.
+ */
+typedef struct SpinLock SpinLock;
+
+SpinLock *InitSpinLock(LockKind kind, int maxThreads);
+
+void AcquireSpinLock(SpinLock *lock, int threadNum);
+
+void ReleaseSpinLock(SpinLock *lock, int threadNum);
+
+void FreeSpinLock(SpinLock *lock);
+
+const char *GetLockKindName(LockKind kind);
+
+int PerformLockContentionComparison();
+
+void RegisterLockContentionBenchmarks();
+
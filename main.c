@@ -4,16 +4,57 @@
 #include "matrixMiniMax/matrixMiniMax.h"
 #include "matrixMiniMax/matrixMiniMaxForSpecialTypes.h"
 #include "reductions/reductions.h"
+#include "reductions/scan.h"
+#include "reductions/histogram.h"
+#include "locks/spinlocks.h"
 #include <stddef.h>
 #include "stdlib.h"
 #include <time.h>
 #include "nestedParallelism/nestedParallelism.h"
 #include "differentCycleModes/differentCycleModes.h"
+#include "matrixMultiply/matrixMultiply.h"
+#include "spmv/spmv.h"
+#include "vectorSelect/vectorSelect.h"
+#include "sort/sort.h"
+#include "search/search.h"
+#include "benchmark/cli.h"
+#include "benchmark/roofline.h"
+
+static void registerAllBenchmarks()
+{
+    RegisterFindMinBenchmarks();
+    RegisterDotProductBenchmarks();
+    RegisterIntegralBenchmarks();
+    RegisterMiniMaxBenchmarks();
+    RegisterMiniMaxForSpecTypesBenchmarks();
+    RegisterReductionsBenchmarks();
+    RegisterScanBenchmarks();
+    RegisterHistogramBenchmarks();
+    RegisterLockContentionBenchmarks();
+    RegisterNestedParallelismBenchmarks();
+    RegisterDifferentCycleModesBenchmarks();
+    RegisterMatrixMultiplyBenchmarks();
+    RegisterSpmvBenchmarks();
+    RegisterSelectBenchmarks();
+    RegisterSortBenchmarks();
+    RegisterSearchBenchmarks();
+    RegisterRooflineBenchmarks();
+}
 
 int main(int argc,
          char *argv[])
 {
     srand(time(NULL));
+    if (argc < 2)
+    {
+        PrintUsage(argv[0]);
+        return 2;
+    }
+    if (argv[1][0] == '-')
+    {
+        registerAllBenchmarks();
+        return RunBenchmarkCli(argc, argv);
+    }
     switch (*argv[1])
     {
     case '1':
@@ -32,8 +73,16 @@ int main(int argc,
         return PerformNestedParallelismComparison();
     case 'B':
         return PerformDifferentCycleModesComparison();
+    case 'C':
+        return PerformWorkloadSchedulesComparison();
+    case 'D':
+        return PerformLockContentionComparison();
+    case 'E':
+        return PerformScanComparison();
+    case 'F':
+        return PerformHistogramComparison();
     default:
-        break;
+        PrintUsage(argv[0]);
+        return 2;
     }
-    return 0;
 }
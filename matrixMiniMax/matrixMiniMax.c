@@ -3,6 +3,7 @@
 #include "malloc.h"
 #include "omp.h"
 #include "../utils/utils.h"
+#include "../benchmark/registry.h"
 
 static int findMiniMaxSingleThread(Matrix *matrix)
 {
@@ -83,6 +84,12 @@ static int findMiniMaxReduction(Matrix *matrix)
     return maxVal;
 }
 
+int FindMiniMaxWithReduction(int *data, int nRows, int nCols)
+{
+    Matrix matrix = {.data = data, .nRows = nRows, .nCols = nCols};
+    return findMiniMaxReduction(&matrix);
+}
+
 static double measure(int (*method)(Matrix *), Matrix *matrix)
 {
     double start = omp_get_wtime();
@@ -140,3 +147,52 @@ int PerformMiniMaxSearchComparison()
     fclose(f);
     return 0;
 }
+
+static void *setupMiniMax(int size, const void *parameters)
+{
+    Matrix *matrix = InitMatrix(size, size);
+    FillMatrixWithRandomValues(matrix);
+    return matrix;
+}
+
+static void teardownMiniMax(void *input)
+{
+    FreeMatrix(input);
+    free(input);
+}
+
+static double runFindMiniMaxSingleThread(void *input)
+{
+    return findMiniMaxSingleThread(input);
+}
+
+static double runFindMiniMaxCriticalSection(void *input)
+{
+    return findMiniMaxCriticalSection(input);
+}
+
+static double runFindMiniMaxReduction(void *input)
+{
+    return findMiniMaxReduction(input);
+}
+
+static BenchmarkWork workMiniMax(const void *input)
+{
+    const Matrix *matrix = input;
+    double numElems = (double)matrix->nRows * matrix->nCols;
+    return (BenchmarkWork){.bytes = sizeof(int) * numElems, .operations = numElems};
+}
+
+void RegisterMiniMaxBenchmarks()
+{
+    const BenchmarkGroup *group = RegisterBenchmarkGroup((BenchmarkGroup){
+        .name = "matrixMiniMax",
+        .setup = setupMiniMax,
+        .teardown = teardownMiniMax,
+        .work = workMiniMax,
+        .numDefaultSizes = 3,
+        .defaultSizes = {10, 100, 1000}});
+    RegisterBenchmark(group, "single", runFindMiniMaxSingleThread, 0);
+    RegisterBenchmark(group, "critical_section", runFindMiniMaxCriticalSection, 1);
+    RegisterBenchmark(group, "reduction", runFindMiniMaxReduction, 1);
+}
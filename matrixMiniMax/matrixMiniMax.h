@@ -3,4 +3,9 @@
 #endif 
 
 
-int PerformMiniMaxSearchComparison();
\ No newline at end of file
+// Largest row minimum of a row-major nRows x nCols matrix, with a reduction.
+int FindMiniMaxWithReduction(int *data, int nRows, int nCols);
+
+int PerformMiniMaxSearchComparison();
+
+void RegisterMiniMaxBenchmarks();
@@ -4,6 +4,8 @@
 #include "stdlib.h"
 #include "../utils/utils.h"
 #include "stdio.h"
+#include "../benchmark/registry.h"
+#include "../benchmark/loadBalance.h"
 
 static int findMiniMaxSingleThread(Matrix *matrix)
 {
@@ -28,11 +30,14 @@ static int findMiniMaxSingleThread(Matrix *matrix)
     return maxVal;
 }
 
-static int findMiniMaxReduction(Matrix *matrix)
+/*
+ * Serial counterpart of findMiniMaxReduction: only the lower triangle,
+ * diagonal included, so it reads the same elements and returns the same
+ * value. findMiniMaxSingleThread scans whole rows, zeros included.
+ */
+static int findMiniMaxLowerSingleThread(Matrix *matrix)
 {
     int maxVal = INT_MIN;
-#pragma omp parallel for shared(matrix) reduction(max \
-                                                  : maxVal) schedule(runtime)
     for (int i = 0; i < matrix->nRows; i++)
     {
         int rowMin = GetMatrixElem(matrix, i, 0);
@@ -44,12 +49,42 @@ static int findMiniMaxReduction(Matrix *matrix)
                 rowMin = curr;
             }
         }
-
         if (rowMin > maxVal)
         {
             maxVal = rowMin;
         }
     }
+    return maxVal;
+}
+
+static int findMiniMaxReduction(Matrix *matrix)
+{
+    int maxVal = INT_MIN;
+#pragma omp parallel shared(matrix) reduction(max \
+                                              : maxVal)
+    {
+        LOAD_BALANCE_THREAD_BEGIN();
+#pragma omp for schedule(runtime) nowait
+        for (int i = 0; i < matrix->nRows; i++)
+        {
+            LOAD_BALANCE_ITERATION();
+            int rowMin = GetMatrixElem(matrix, i, 0);
+            for (int j = 1; j <= i; j++)
+            {
+                int curr = GetMatrixElem(matrix, i, j);
+                if (curr < rowMin)
+                {
+                    rowMin = curr;
+                }
+            }
+
+            if (rowMin > maxVal)
+            {
+                maxVal = rowMin;
+            }
+        }
+        LOAD_BALANCE_THREAD_END();
+    }
 
     return maxVal;
 }
@@ -90,4 +125,65 @@ int PerformMiniMaxSearchForSpecTypesComparison()
     }
     fclose(f);
     return 0;
-}
\ No newline at end of file
+}
+
+static void *setupTriangularMiniMax(int size, const void *parameters)
+{
+    Matrix *matrix = InitMatrix(size, size);
+    FillLowerTriangularMatrixWithRandomValues(matrix);
+    return matrix;
+}
+
+static void teardownTriangularMiniMax(void *input)
+{
+    FreeMatrix(input);
+    free(input);
+}
+
+// The registered serial baseline scans the triangle like the parallel
+// variants; the legacy comparison keeps the full row scan.
+static double runFindMiniMaxSingleThread(void *input)
+{
+    return findMiniMaxLowerSingleThread(input);
+}
+
+static double runFindMiniMaxStatic(void *input)
+{
+    omp_set_schedule(omp_sched_static, 2);
+    return findMiniMaxReduction(input);
+}
+
+static double runFindMiniMaxDynamic(void *input)
+{
+    omp_set_schedule(omp_sched_dynamic, 2);
+    return findMiniMaxReduction(input);
+}
+
+static double runFindMiniMaxGuided(void *input)
+{
+    omp_set_schedule(omp_sched_guided, 2);
+    return findMiniMaxReduction(input);
+}
+
+// Every registered variant reads the lower triangle, diagonal included.
+static BenchmarkWork workTriangularMiniMax(const void *input)
+{
+    const Matrix *matrix = input;
+    double numElems = (double)matrix->nRows * (matrix->nRows + 1) / 2;
+    return (BenchmarkWork){.bytes = sizeof(int) * numElems, .operations = numElems};
+}
+
+void RegisterMiniMaxForSpecTypesBenchmarks()
+{
+    const BenchmarkGroup *group = RegisterBenchmarkGroup((BenchmarkGroup){
+        .name = "matrixMiniMaxForSpecTypes",
+        .setup = setupTriangularMiniMax,
+        .teardown = teardownTriangularMiniMax,
+        .work = workTriangularMiniMax,
+        .numDefaultSizes = 2,
+        .defaultSizes = {100, 1000}});
+    RegisterBenchmark(group, "single", runFindMiniMaxSingleThread, 0);
+    RegisterBenchmark(group, "static", runFindMiniMaxStatic, 1);
+    RegisterBenchmark(group, "dynamic", runFindMiniMaxDynamic, 1);
+    RegisterBenchmark(group, "guided", runFindMiniMaxGuided, 1);
+}
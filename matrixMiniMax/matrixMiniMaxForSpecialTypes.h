@@ -2,4 +2,6 @@
 #define OPENMP_MINIMAXSPEC_H
 #endif
 
-int PerformMiniMaxSearchForSpecTypesComparison();
\ No newline at end of file
+int PerformMiniMaxSearchForSpecTypesComparison();
+
+void RegisterMiniMaxForSpecTypesBenchmarks();
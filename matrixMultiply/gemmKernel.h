@@ -0,0 +1,154 @@
+// Blocked GEMM for one element type, included once per type by
+// matrixMultiply.c with GEMM_INPUT, GEMM_ACCUMULATOR and GEMM_SUFFIX set.
+// There is deliberately no include guard.
+
+#define GEMM_NAME(name) GEMM_CONCAT(name, GEMM_SUFFIX)
+#define GEMM_LANES (VECTOR_BYTES / (int)sizeof(GEMM_ACCUMULATOR))
+#define GEMM_NR (2 * GEMM_LANES)
+
+typedef GEMM_ACCUMULATOR GEMM_NAME(Vector) __attribute__((vector_size(VECTOR_BYTES)));
+
+static void GEMM_NAME(gemmNaive)(const GEMM_INPUT *a, const GEMM_INPUT *b, GEMM_ACCUMULATOR *c, int size)
+{
+    int i;
+#pragma omp parallel for shared(a, b, c, size) private(i) default(none)
+    for (i = 0; i < size; i++)
+    {
+        for (int j = 0; j < size; j++)
+        {
+            GEMM_ACCUMULATOR sum = 0;
+            for (int k = 0; k < size; k++)
+            {
+                sum += (GEMM_ACCUMULATOR)a[(size_t)i * size + k] * b[(size_t)k * size + j];
+            }
+            c[(size_t)i * size + j] = sum;
+        }
+    }
+}
+
+/*
+ * Rows [0, numRows) and columns [0, depth) of a, in GEMM_MR-row slivers
+ * stored column by column, so the micro-kernel reads them sequentially.
+ * Rows past numRows are zero.
+ */
+static void GEMM_NAME(packA)(const GEMM_INPUT *a, int lda, int numRows, int depth, GEMM_ACCUMULATOR *packed)
+{
+    for (int sliver = 0; sliver < numRows; sliver += GEMM_MR)
+    {
+        for (int k = 0; k < depth; k++)
+        {
+            for (int i = 0; i < GEMM_MR; i++)
+            {
+                *packed++ = sliver + i < numRows ? a[(size_t)(sliver + i) * lda + k] : 0;
+            }
+        }
+    }
+}
+
+// One GEMM_NR-column sliver of b, row by row, zero past numCols.
+static void GEMM_NAME(packB)(const GEMM_INPUT *b, int ldb, int depth, int numCols, GEMM_ACCUMULATOR *packed)
+{
+    for (int k = 0; k < depth; k++)
+    {
+        for (int j = 0; j < GEMM_NR; j++)
+        {
+            *packed++ = j < numCols ? b[(size_t)k * ldb + j] : 0;
+        }
+    }
+}
+
+/*
+ * Adds the product of a packed A sliver and a packed B sliver to the
+ * numRows x numCols corner of a GEMM_MR x GEMM_NR tile of c. The tile is
+ * accumulated in 2 * GEMM_MR vectors, every B row is loaded once and every
+ * A value broadcast once per k.
+ */
+static void GEMM_NAME(microKernel)(int depth, const GEMM_ACCUMULATOR *a, const GEMM_ACCUMULATOR *b,
+                                   GEMM_ACCUMULATOR *c, int ldc, int numRows, int numCols)
+{
+    const GEMM_NAME(Vector) zero = {0};
+    GEMM_NAME(Vector) sums0Low = zero, sums0High = zero, sums1Low = zero, sums1High = zero;
+    GEMM_NAME(Vector) sums2Low = zero, sums2High = zero, sums3Low = zero, sums3High = zero;
+    for (int k = 0; k < depth; k++)
+    {
+        const GEMM_NAME(Vector) low = *(const GEMM_NAME(Vector) *)b;
+        const GEMM_NAME(Vector) high = *(const GEMM_NAME(Vector) *)(b + GEMM_LANES);
+        sums0Low += a[0] * low;
+        sums0High += a[0] * high;
+        sums1Low += a[1] * low;
+        sums1High += a[1] * high;
+        sums2Low += a[2] * low;
+        sums2High += a[2] * high;
+        sums3Low += a[3] * low;
+        sums3High += a[3] * high;
+        a += GEMM_MR;
+        b += GEMM_NR;
+    }
+
+    GEMM_NAME(Vector) tile[GEMM_MR][2] = {{sums0Low, sums0High}, {sums1Low, sums1High},
+                                          {sums2Low, sums2High}, {sums3Low, sums3High}};
+    const GEMM_ACCUMULATOR *sums = (const GEMM_ACCUMULATOR *)tile;
+    for (int i = 0; i < numRows; i++)
+    {
+        for (int j = 0; j < numCols; j++)
+        {
+            c[(size_t)i * ldc + j] += sums[i * GEMM_NR + j];
+        }
+    }
+}
+
+/*
+ * c = a * b for size x size row-major matrices. For every GEMM_NC-column
+ * block of b and GEMM_KC-deep slice of the inner dimension, the team packs
+ * the b panel together and then shares the GEMM_MC-row macro-tiles of c
+ * dynamically; each thread packs its own a block.
+ */
+static void GEMM_NAME(gemmBlocked)(const GEMM_INPUT *a, const GEMM_INPUT *b, GEMM_ACCUMULATOR *c, int size)
+{
+    GEMM_ACCUMULATOR *packedB = memalign(PACK_ALIGNMENT, sizeof(GEMM_ACCUMULATOR) * GEMM_KC * GEMM_NC);
+#pragma omp parallel shared(a, b, c, size, packedB) default(none)
+    {
+        GEMM_ACCUMULATOR *packedA = memalign(PACK_ALIGNMENT, sizeof(GEMM_ACCUMULATOR) * GEMM_MC * GEMM_KC);
+#pragma omp for
+        for (int i = 0; i < size; i++)
+        {
+            memset(c + (size_t)i * size, 0, sizeof(GEMM_ACCUMULATOR) * size);
+        }
+        for (int jc = 0; jc < size; jc += GEMM_NC)
+        {
+            int numCols = size - jc < GEMM_NC ? size - jc : GEMM_NC;
+            for (int pc = 0; pc < size; pc += GEMM_KC)
+            {
+                int depth = size - pc < GEMM_KC ? size - pc : GEMM_KC;
+#pragma omp for
+                for (int jr = 0; jr < numCols; jr += GEMM_NR)
+                {
+                    GEMM_NAME(packB)(b + (size_t)pc * size + jc + jr, size, depth,
+                                     numCols - jr < GEMM_NR ? numCols - jr : GEMM_NR, packedB + (size_t)jr * depth);
+                }
+#pragma omp for schedule(dynamic, 1)
+                for (int ic = 0; ic < size; ic += GEMM_MC)
+                {
+                    int numRows = size - ic < GEMM_MC ? size - ic : GEMM_MC;
+                    GEMM_NAME(packA)(a + (size_t)ic * size + pc, size, numRows, depth, packedA);
+                    for (int jr = 0; jr < numCols; jr += GEMM_NR)
+                    {
+                        for (int ir = 0; ir < numRows; ir += GEMM_MR)
+                        {
+                            GEMM_NAME(microKernel)(depth, packedA + (size_t)ir * depth, packedB + (size_t)jr * depth,
+                                                   c + (size_t)(ic + ir) * size + jc + jr, size,
+                                                   numRows - ir < GEMM_MR ? numRows - ir : GEMM_MR,
+                                                   numCols - jr < GEMM_NR ? numCols - jr : GEMM_NR);
+                        }
+                    }
+                }
+            }
+        }
+        free(packedA);
+    }
+    free(packedB);
+}
+
+#undef GEMM_NAME
+#undef GEMM_LANES
+#undef GEMM_NR
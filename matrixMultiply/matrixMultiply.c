@@ -0,0 +1,213 @@
+#include "./matrixMultiply.h"
+#include "omp.h"
+#include "malloc.h"
+#include "string.h"
+#include "../utils/utils.h"
+#include "../datatypes/hugePages.h"
+#include "../benchmark/registry.h"
+
+/*
+ * Dense square GEMM, c = a * b, for int32 inputs accumulated in int64 and
+ * for float and double. The blocked variant follows the usual layering:
+ * GEMM_NC columns of b and GEMM_KC of the inner dimension are packed into
+ * an L3-sized panel, GEMM_MC rows of a into an L2-sized block, and a
+ * GEMM_MR x GEMM_NR register tile is updated from L1-resident slivers.
+ * The micro-kernel uses the compiler's generic vector types, so it stays
+ * SIMD without target specific intrinsics or flags; VECTOR_BYTES of 16 is
+ * what every x86-64 and AArch64 target has.
+ */
+#define VECTOR_BYTES 16
+#define PACK_ALIGNMENT 64
+// The micro-kernel is written out for four rows.
+#define GEMM_MR 4
+#define GEMM_KC 256
+#define GEMM_MC 96
+#define GEMM_NC 2048
+
+#define GEMM_CONCAT_TOKENS(name, suffix) name##suffix
+#define GEMM_CONCAT(name, suffix) GEMM_CONCAT_TOKENS(name, suffix)
+
+#define GEMM_INPUT int
+#define GEMM_ACCUMULATOR long long
+#define GEMM_SUFFIX Int
+#include "gemmKernel.h"
+#undef GEMM_INPUT
+#undef GEMM_ACCUMULATOR
+#undef GEMM_SUFFIX
+
+#define GEMM_INPUT float
+#define GEMM_ACCUMULATOR float
+#define GEMM_SUFFIX Float
+#include "gemmKernel.h"
+#undef GEMM_INPUT
+#undef GEMM_ACCUMULATOR
+#undef GEMM_SUFFIX
+
+#define GEMM_INPUT double
+#define GEMM_ACCUMULATOR double
+#define GEMM_SUFFIX Double
+#include "gemmKernel.h"
+#undef GEMM_INPUT
+#undef GEMM_ACCUMULATOR
+#undef GEMM_SUFFIX
+
+typedef enum GemmType
+{
+    GEMM_INT,
+    GEMM_FLOAT,
+    GEMM_DOUBLE
+} GemmType;
+
+static const size_t inputSizes[] = {sizeof(int), sizeof(float), sizeof(double)};
+static const size_t outputSizes[] = {sizeof(long long), sizeof(float), sizeof(double)};
+
+/*
+ * The int inputs are Matrix objects filled like the other matrix
+ * benchmarks; float and double get the same values converted.
+ */
+typedef struct GemmInput
+{
+    GemmType type;
+    int size;
+    Matrix *intA;
+    Matrix *intB;
+    void *a;
+    void *b;
+    void *c;
+} GemmInput;
+
+static void *convertMatrix(const Matrix *matrix, GemmType type)
+{
+    size_t numElems = (size_t)matrix->nRows * matrix->nCols;
+    if (type == GEMM_INT)
+    {
+        return matrix->data;
+    }
+    void *converted = AllocatePages(numElems * inputSizes[type]);
+    for (size_t i = 0; i < numElems; i++)
+    {
+        if (type == GEMM_FLOAT)
+        {
+            ((float *)converted)[i] = (float)matrix->data[i];
+        }
+        else
+        {
+            ((double *)converted)[i] = matrix->data[i];
+        }
+    }
+    return converted;
+}
+
+static void *setupGemm(int size, const void *parameters)
+{
+    GemmInput *input = malloc(sizeof(GemmInput));
+    input->type = *(const GemmType *)parameters;
+    input->size = size;
+    input->intA = InitMatrix(size, size);
+    input->intB = InitMatrix(size, size);
+    FillMatrixWithRandomValues(input->intA);
+    FillMatrixWithRandomValues(input->intB);
+    input->a = convertMatrix(input->intA, input->type);
+    input->b = convertMatrix(input->intB, input->type);
+    input->c = AllocatePages((size_t)size * size * outputSizes[input->type]);
+    return input;
+}
+
+static void teardownGemm(void *input)
+{
+    GemmInput *g = input;
+    if (g->type != GEMM_INT)
+    {
+        FreePages(g->a);
+        FreePages(g->b);
+    }
+    FreeMatrix(g->intA);
+    FreeMatrix(g->intB);
+    free(g->intA);
+    free(g->intB);
+    FreePages(g->c);
+    free(g);
+}
+
+// Corner elements of c, enough to keep the product alive.
+static double checksum(const GemmInput *g)
+{
+    size_t last = (size_t)g->size * g->size - 1;
+    switch (g->type)
+    {
+    case GEMM_INT:
+        return (double)(((long long *)g->c)[0] + ((long long *)g->c)[last]);
+    case GEMM_FLOAT:
+        return ((float *)g->c)[0] + ((float *)g->c)[last];
+    default:
+        return ((double *)g->c)[0] + ((double *)g->c)[last];
+    }
+}
+
+static double runNaive(void *input)
+{
+    GemmInput *g = input;
+    switch (g->type)
+    {
+    case GEMM_INT:
+        gemmNaiveInt(g->a, g->b, g->c, g->size);
+        break;
+    case GEMM_FLOAT:
+        gemmNaiveFloat(g->a, g->b, g->c, g->size);
+        break;
+    case GEMM_DOUBLE:
+        gemmNaiveDouble(g->a, g->b, g->c, g->size);
+        break;
+    }
+    return checksum(g);
+}
+
+static double runBlocked(void *input)
+{
+    GemmInput *g = input;
+    switch (g->type)
+    {
+    case GEMM_INT:
+        gemmBlockedInt(g->a, g->b, g->c, g->size);
+        break;
+    case GEMM_FLOAT:
+        gemmBlockedFloat(g->a, g->b, g->c, g->size);
+        break;
+    case GEMM_DOUBLE:
+        gemmBlockedDouble(g->a, g->b, g->c, g->size);
+        break;
+    }
+    return checksum(g);
+}
+
+// A multiply and an add per inner product step; a and b read and c
+// written once, the cache reuse the blocking buys is not counted. The int
+// variant accumulates in 64 bits and is held against the integer ceiling.
+static BenchmarkWork workGemm(const void *input)
+{
+    const GemmInput *g = input;
+    double numElems = (double)g->size * g->size;
+    return (BenchmarkWork){.bytes = numElems * (2 * inputSizes[g->type] + outputSizes[g->type]),
+                           .operations = 2 * numElems * g->size,
+                           .integerOperations = g->type == GEMM_INT};
+}
+
+static const GemmType registeredTypes[] = {GEMM_INT, GEMM_FLOAT, GEMM_DOUBLE};
+static const char *registeredGroupNames[] = {"gemm_int32", "gemm_float", "gemm_double"};
+
+void RegisterMatrixMultiplyBenchmarks()
+{
+    for (int t = 0; t < 3; t++)
+    {
+        const BenchmarkGroup *group = RegisterBenchmarkGroup((BenchmarkGroup){
+            .name = registeredGroupNames[t],
+            .setup = setupGemm,
+            .teardown = teardownGemm,
+            .work = workGemm,
+            .parameters = &registeredTypes[t],
+            .numDefaultSizes = 2,
+            .defaultSizes = {128, 512}});
+        RegisterBenchmark(group, "naive", runNaive, 1);
+        RegisterBenchmark(group, "blocked", runBlocked, 1);
+    }
+}
@@ -0,0 +1,5 @@
+#ifndef OPENMP_MATRIX_MULTIPLY_H
+#define OPENMP_MATRIX_MULTIPLY_H
+#endif
+
+void RegisterMatrixMultiplyBenchmarks();
@@ -0,0 +1,280 @@
+#include "../dotProduct/dotProduct.h"
+#include "../integrals/integrals.h"
+#include "../datatypes/hugePages.h"
+#include "../benchmark/cli.h"
+#include "omp.h"
+#include "math.h"
+#include "string.h"
+#include <getopt.h>
+#include <mpi.h>
+#include <unistd.h>
+
+/*
+ * Hybrid MPI + OpenMP scaling sweep of the dot product and the integral.
+ * Every kernel runs with a block of the input per rank, OpenMP inside the
+ * rank and MPI_Allreduce to combine. For a fixed budget of cores the sweep
+ * splits them into ranks x threads for every rank count that divides the
+ * budget and is at most the number of started ranks; ranks outside the
+ * split wait without spinning. Run it with
+ *
+ *   mpirun -np 4 --bind-to none openmpHybrid --cores 8
+ *
+ * so that the threads of a rank are not confined to the rank's core.
+ */
+
+#define MAX_HYBRID_SIZES 16
+#define MAX_HYBRID_REPETITIONS 1000
+#define DEFAULT_HYBRID_REPETITIONS 10
+
+typedef struct HybridRun
+{
+    MPI_Comm comm;
+    int size;
+    // Block of the global index range owned by this rank.
+    long long offset;
+    int localSize;
+    int *a;
+    int *b;
+    double result;
+} HybridRun;
+
+/*
+ * Element index of a global vector, from a hash of the index rather than
+ * rand(), so the combined result does not depend on the decomposition.
+ */
+static int valueAt(long long index, int size, unsigned int salt)
+{
+    unsigned int x = (unsigned int)index * 0x9E3779B1u ^ salt;
+    x ^= x >> 16;
+    x *= 0x85EBCA6Bu;
+    x ^= x >> 13;
+    return (int)(x % (2u * size + 1)) - size;
+}
+
+static void runDot(HybridRun *run)
+{
+    int local = dotProductWithReduction(run->a, run->b, run->localSize, run->localSize);
+    int global;
+    MPI_Allreduce(&local, &global, 1, MPI_INT, MPI_SUM, run->comm);
+    run->result = global;
+}
+
+// Midpoint rule for exp over [0, 100] like the integrals group; every rank
+// takes its block of the rectangles.
+static void runIntegral(HybridRun *run)
+{
+    double h = 100.0 / run->size;
+    double local = run->localSize > 0
+                       ? IntegrateWithReduction(exp, run->offset * h, (run->offset + run->localSize) * h, run->localSize)
+                       : 0;
+    double global;
+    MPI_Allreduce(&local, &global, 1, MPI_DOUBLE, MPI_SUM, run->comm);
+    run->result = global;
+}
+
+// Barrier for the whole job that sleeps instead of busy polling, so idle
+// ranks leave their cores to the ranks being measured.
+static void waitForAll()
+{
+    MPI_Request request;
+    int done = 0;
+    MPI_Ibarrier(MPI_COMM_WORLD, &request);
+    while (!done)
+    {
+        MPI_Test(&request, &done, MPI_STATUS_IGNORE);
+        if (!done)
+        {
+            usleep(1000);
+        }
+    }
+}
+
+/*
+ * Times one kernel on numRanks ranks with numThreads threads each. A
+ * sample is the slowest rank's time from a common barrier to the end of
+ * the Allreduce. Returns the result on rank 0 of the split.
+ */
+static double measureSplit(void (*kernel)(HybridRun *), int useArrays, int size, int numRanks, int numThreads,
+                           int warmupRuns, int repetitions, double *samples)
+{
+    int worldRank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &worldRank);
+    HybridRun run = {.size = size, .result = NAN};
+    MPI_Comm_split(MPI_COMM_WORLD, worldRank < numRanks ? 0 : MPI_UNDEFINED, worldRank, &run.comm);
+    if (run.comm == MPI_COMM_NULL)
+    {
+        return NAN;
+    }
+
+    run.offset = (long long)size / numRanks * worldRank + (worldRank < size % numRanks ? worldRank : size % numRanks);
+    run.localSize = size / numRanks + (worldRank < size % numRanks);
+    run.a = NULL;
+    run.b = NULL;
+    if (useArrays)
+    {
+        run.a = AllocatePages(sizeof(int) * (run.localSize > 0 ? run.localSize : 1));
+        run.b = AllocatePages(sizeof(int) * (run.localSize > 0 ? run.localSize : 1));
+        for (int i = 0; i < run.localSize; i++)
+        {
+            run.a[i] = valueAt(run.offset + i, size, 0x1234567u);
+            run.b[i] = valueAt(run.offset + i, size, 0x89ABCDEu);
+        }
+    }
+    omp_set_num_threads(numThreads);
+
+    for (int i = 0; i < warmupRuns; i++)
+    {
+        kernel(&run);
+    }
+    for (int i = 0; i < repetitions; i++)
+    {
+        MPI_Barrier(run.comm);
+        double start = MPI_Wtime();
+        kernel(&run);
+        double elapsed = (MPI_Wtime() - start) * 1000;
+        MPI_Reduce(&elapsed, &samples[i], 1, MPI_DOUBLE, MPI_MAX, 0, run.comm);
+    }
+
+    if (useArrays)
+    {
+        FreePages(run.a);
+        FreePages(run.b);
+    }
+    MPI_Comm_free(&run.comm);
+    return run.result;
+}
+
+static void printUsage(const char *program)
+{
+    fprintf(stderr,
+            "Usage: mpirun -np RANKS --bind-to none %s [--cores N] [--bench dot|integrals|all]\n"
+            "          [--sizes LIST] [--warmup N] [--reps N]\n"
+            "\n"
+            "  --cores N      cores split into ranks x threads (default: processors of rank 0)\n"
+            "  --bench NAME   kernel to sweep (default: all)\n"
+            "  --sizes LIST   global problem sizes (default: 100,1e5,1e8 for dot,\n"
+            "                 100,1e4,1e6 for integrals)\n"
+            "  --warmup N     untimed calls per split (default: 1)\n"
+            "  --reps N       timed calls per split (default: %d)\n",
+            program, DEFAULT_HYBRID_REPETITIONS);
+}
+
+typedef struct HybridKernel
+{
+    const char *name;
+    void (*kernel)(HybridRun *);
+    int useArrays;
+    int numDefaultSizes;
+    int defaultSizes[3];
+} HybridKernel;
+
+static const HybridKernel kernels[] = {
+    {"dot", runDot, 1, 3, {100, 100000, 100000000}},
+    {"integrals", runIntegral, 0, 3, {100, 10000, 1000000}},
+};
+
+int main(int argc, char *argv[])
+{
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+    int worldRank, worldSize;
+    MPI_Comm_rank(MPI_COMM_WORLD, &worldRank);
+    MPI_Comm_size(MPI_COMM_WORLD, &worldSize);
+
+    static const struct option options[] = {
+        {"cores", required_argument, NULL, 'c'},
+        {"bench", required_argument, NULL, 'b'},
+        {"sizes", required_argument, NULL, 's'},
+        {"warmup", required_argument, NULL, 'w'},
+        {"reps", required_argument, NULL, 'r'},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0}};
+    int cores = omp_get_num_procs();
+    const char *bench = "all";
+    int numSizes = 0;
+    int sizes[MAX_HYBRID_SIZES];
+    int warmupRuns = 1;
+    int repetitions = DEFAULT_HYBRID_REPETITIONS;
+    int invalid = 0;
+    int option;
+    while ((option = getopt_long(argc, argv, "", options, NULL)) != -1)
+    {
+        char *end;
+        switch (option)
+        {
+        case 'c':
+            cores = (int)strtol(optarg, &end, 10);
+            invalid |= *end != '\0' || cores <= 0;
+            break;
+        case 'b':
+            bench = optarg;
+            break;
+        case 's':
+            numSizes = ParseIntList(optarg, sizes, MAX_HYBRID_SIZES);
+            invalid |= numSizes <= 0;
+            break;
+        case 'w':
+            warmupRuns = (int)strtol(optarg, &end, 10);
+            invalid |= *end != '\0' || warmupRuns < 0;
+            break;
+        case 'r':
+            repetitions = (int)strtol(optarg, &end, 10);
+            invalid |= *end != '\0' || repetitions <= 0 || repetitions > MAX_HYBRID_REPETITIONS;
+            break;
+        default:
+            invalid = 1;
+        }
+    }
+    // Every rank parses the same arguments; rank 0 alone complains and
+    // everybody agrees on its core count.
+    MPI_Bcast(&cores, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    if (invalid || optind < argc ||
+        (strcmp(bench, "all") != 0 && strcmp(bench, "dot") != 0 && strcmp(bench, "integrals") != 0))
+    {
+        if (worldRank == 0)
+        {
+            printUsage(argv[0]);
+        }
+        MPI_Finalize();
+        return 2;
+    }
+
+    double samples[MAX_HYBRID_REPETITIONS];
+    if (worldRank == 0)
+    {
+        printf("kernel;size;ranks;threads_per_rank;repetitions;min;median;mean;max;stddev;result\n");
+        fflush(stdout);
+    }
+    for (int k = 0; k < (int)(sizeof(kernels) / sizeof(kernels[0])); k++)
+    {
+        if (strcmp(bench, "all") != 0 && strcmp(bench, kernels[k].name) != 0)
+        {
+            continue;
+        }
+        int kernelNumSizes = numSizes > 0 ? numSizes : kernels[k].numDefaultSizes;
+        const int *kernelSizes = numSizes > 0 ? sizes : kernels[k].defaultSizes;
+        for (int s = 0; s < kernelNumSizes; s++)
+        {
+            for (int numRanks = 1; numRanks <= worldSize && numRanks <= cores; numRanks++)
+            {
+                if (cores % numRanks != 0)
+                {
+                    continue;
+                }
+                double result = measureSplit(kernels[k].kernel, kernels[k].useArrays, kernelSizes[s], numRanks,
+                                             cores / numRanks, warmupRuns, repetitions, samples);
+                waitForAll();
+                if (worldRank == 0)
+                {
+                    MeasurementStats stats = SummarizeSamples(samples, repetitions);
+                    printf("%s;%d;%d;%d;%d;%0.9f;%0.9f;%0.9f;%0.9f;%0.9f;%.17g\n", kernels[k].name, kernelSizes[s],
+                           numRanks, cores / numRanks, stats.repetitions, stats.min, stats.median, stats.mean,
+                           stats.max, stats.stddev, result);
+                    fflush(stdout);
+                }
+            }
+        }
+    }
+    MPI_Finalize();
+    return 0;
+}
@@ -3,6 +3,7 @@
 #include "limits.h"
 #include "omp.h"
 #include "math.h"
+#include "../benchmark/registry.h"
 
 static int findMiniMaxSingleThread(Matrix *matrix)
 {
@@ -149,4 +150,56 @@ int PerformNestedParallelismComparison()
 
     fclose(f);
     return 0;
-}
\ No newline at end of file
+}
+
+static void *setupNestedMiniMax(int size, const void *parameters)
+{
+    Matrix *matrix = InitMatrix(size, size);
+    FillMatrixWithRandomValues(matrix);
+    return matrix;
+}
+
+static void teardownNestedMiniMax(void *input)
+{
+    FreeMatrix(input);
+    free(input);
+}
+
+static double runFindMiniMaxSingleThread(void *input)
+{
+    return findMiniMaxSingleThread(input);
+}
+
+static double runFindMiniMaxReduction(void *input)
+{
+    return findMiniMaxReduction(input);
+}
+
+static double runFindMiniMaxReductionNested(void *input)
+{
+    omp_set_nested(1);
+    int result = findMiniMaxReductionNested(input);
+    omp_set_nested(0);
+    return result;
+}
+
+static BenchmarkWork workNestedMiniMax(const void *input)
+{
+    const Matrix *matrix = input;
+    double numElems = (double)matrix->nRows * matrix->nCols;
+    return (BenchmarkWork){.bytes = sizeof(int) * numElems, .operations = numElems};
+}
+
+void RegisterNestedParallelismBenchmarks()
+{
+    const BenchmarkGroup *group = RegisterBenchmarkGroup((BenchmarkGroup){
+        .name = "nestedParallelism",
+        .setup = setupNestedMiniMax,
+        .teardown = teardownNestedMiniMax,
+        .work = workNestedMiniMax,
+        .numDefaultSizes = 3,
+        .defaultSizes = {10, 100, 1000}});
+    RegisterBenchmark(group, "single", runFindMiniMaxSingleThread, 0);
+    RegisterBenchmark(group, "reduction", runFindMiniMaxReduction, 1);
+    RegisterBenchmark(group, "nested", runFindMiniMaxReductionNested, 1);
+}
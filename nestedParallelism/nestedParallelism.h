@@ -1,2 +1,4 @@
 
-int PerformNestedParallelismComparison();
\ No newline at end of file
+int PerformNestedParallelismComparison();
+
+void RegisterNestedParallelismBenchmarks();
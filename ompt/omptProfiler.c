@@ -0,0 +1,334 @@
+#include "omptProfiler.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include <omp-tools.h>
+#include <pthread.h>
+#include <time.h>
+
+#define MAX_PROFILED_THREADS 1024
+#define MAX_VARIANT_LENGTH 256
+
+/*
+ * Per thread totals of one variant, all times in seconds. Only the owning
+ * thread writes them; they are read and reset between variants, when the
+ * pool threads are idle.
+ */
+typedef struct ThreadProfile
+{
+    int threadNum;
+    long long regions;
+    double regionTime;
+    long long implicitTasks;
+    double startupTime;
+    double taskTime;
+    double barrierWaitTime;
+    double syncWaitTime;
+    double mutexWaitTime;
+    long long mutexAcquisitions;
+    // Begin timestamps of the scopes that are open on this thread.
+    double taskBegin;
+    double syncBegin;
+    double mutexBegin;
+    int inTask;
+    int inSync;
+    int inMutex;
+} ThreadProfile;
+
+static ompt_set_callback_t setCallback;
+
+static ThreadProfile *profiles[MAX_PROFILED_THREADS];
+static int numProfiles = 0;
+static pthread_mutex_t profilesMutex = PTHREAD_MUTEX_INITIALIZER;
+static __thread ThreadProfile *threadProfile;
+
+static FILE *output;
+static char variant[MAX_VARIANT_LENGTH] = "program";
+static long long variantCalls = 0;
+// Begin events are dropped while paused; end events of scopes that began
+// while recording are always taken so no scope is left half counted.
+static volatile int recording = 1;
+
+static double getWtime()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+static ThreadProfile *getThreadProfile()
+{
+    if (threadProfile == NULL)
+    {
+        threadProfile = calloc(1, sizeof(ThreadProfile));
+        pthread_mutex_lock(&profilesMutex);
+        if (numProfiles < MAX_PROFILED_THREADS)
+        {
+            threadProfile->threadNum = numProfiles;
+            profiles[numProfiles++] = threadProfile;
+        }
+        pthread_mutex_unlock(&profilesMutex);
+    }
+    return threadProfile;
+}
+
+static double getDataTime(const ompt_data_t *data)
+{
+    double time;
+    memcpy(&time, &data->value, sizeof(time));
+    return time;
+}
+
+static void setDataTime(ompt_data_t *data, double time)
+{
+    memcpy(&data->value, &time, sizeof(time));
+}
+
+static void onThreadBegin(ompt_thread_t threadType, ompt_data_t *threadData)
+{
+    getThreadProfile();
+}
+
+static void onParallelBegin(ompt_data_t *encounteringTaskData, const ompt_frame_t *encounteringTaskFrame,
+                            ompt_data_t *parallelData, unsigned int requestedParallelism, int flags,
+                            const void *codeptr)
+{
+    setDataTime(parallelData, recording ? getWtime() : 0);
+}
+
+static void onParallelEnd(ompt_data_t *parallelData, ompt_data_t *encounteringTaskData, int flags, const void *codeptr)
+{
+    double begin = getDataTime(parallelData);
+    if (begin > 0)
+    {
+        ThreadProfile *profile = getThreadProfile();
+        profile->regions++;
+        profile->regionTime += getWtime() - begin;
+    }
+}
+
+static void onImplicitTask(ompt_scope_endpoint_t endpoint, ompt_data_t *parallelData, ompt_data_t *taskData,
+                           unsigned int actualParallelism, unsigned int index, int flags)
+{
+    if (flags & ompt_task_initial)
+    {
+        return;
+    }
+    ThreadProfile *profile = getThreadProfile();
+    double now = getWtime();
+    if (endpoint == ompt_scope_begin)
+    {
+        if (!recording || parallelData == NULL || getDataTime(parallelData) == 0)
+        {
+            return;
+        }
+        profile->inTask = 1;
+        profile->taskBegin = now;
+        profile->implicitTasks++;
+        profile->startupTime += now - getDataTime(parallelData);
+    }
+    else if (profile->inTask)
+    {
+        profile->inTask = 0;
+        profile->taskTime += now - profile->taskBegin;
+    }
+}
+
+static void onSyncRegionWait(ompt_sync_region_t kind, ompt_scope_endpoint_t endpoint, ompt_data_t *parallelData,
+                             ompt_data_t *taskData, const void *codeptr)
+{
+    ThreadProfile *profile = getThreadProfile();
+    if (endpoint == ompt_scope_begin)
+    {
+        profile->inSync = profile->inTask;
+        profile->syncBegin = getWtime();
+        return;
+    }
+    if (!profile->inSync)
+    {
+        return;
+    }
+    profile->inSync = 0;
+    double waited = getWtime() - profile->syncBegin;
+    switch (kind)
+    {
+    case ompt_sync_region_barrier:
+    case ompt_sync_region_barrier_implicit:
+    case ompt_sync_region_barrier_explicit:
+    case ompt_sync_region_barrier_implementation:
+        profile->barrierWaitTime += waited;
+        break;
+    default:
+        profile->syncWaitTime += waited;
+        break;
+    }
+}
+
+static void onMutexAcquire(ompt_mutex_t kind, unsigned int hint, unsigned int impl, ompt_wait_id_t waitId,
+                           const void *codeptr)
+{
+    ThreadProfile *profile = getThreadProfile();
+    profile->inMutex = recording;
+    profile->mutexBegin = getWtime();
+}
+
+static void onMutexAcquired(ompt_mutex_t kind, ompt_wait_id_t waitId, const void *codeptr)
+{
+    ThreadProfile *profile = getThreadProfile();
+    if (!profile->inMutex)
+    {
+        return;
+    }
+    profile->inMutex = 0;
+    profile->mutexWaitTime += getWtime() - profile->mutexBegin;
+    profile->mutexAcquisitions++;
+}
+
+static void printProfile(const char *thread, long long regions, double regionTime, long long implicitTasks,
+                         double startupTime, double workTime, double barrierWaitTime, double syncWaitTime,
+                         double mutexWaitTime, long long mutexAcquisitions, double workRatio)
+{
+    fprintf(output, "%s;%s;%lld;%lld;%.6f;%lld;%.6f;%.6f;%.6f;%.6f;%.6f;%lld;%.3f\n", variant, thread, variantCalls,
+            regions, regionTime * 1e3, implicitTasks, startupTime * 1e3, workTime * 1e3, barrierWaitTime * 1e3,
+            syncWaitTime * 1e3, mutexWaitTime * 1e3, mutexAcquisitions, workRatio);
+}
+
+static double getWorkTime(const ThreadProfile *profile)
+{
+    return profile->taskTime - profile->barrierWaitTime - profile->syncWaitTime - profile->mutexWaitTime;
+}
+
+/*
+ * One row per thread that took part in the variant and a summary row with
+ * thread "all" holding the totals. work_ratio is a thread's work over the
+ * mean work of the team, so the summary's max ratio is the imbalance.
+ */
+static void flushVariant()
+{
+    ThreadProfile total = {0};
+    int numActive = 0;
+    double maxWork = 0;
+    for (int t = 0; t < numProfiles; t++)
+    {
+        const ThreadProfile *profile = profiles[t];
+        if (profile->implicitTasks == 0 && profile->regions == 0 && profile->mutexAcquisitions == 0)
+        {
+            continue;
+        }
+        numActive++;
+        total.regions += profile->regions;
+        total.regionTime += profile->regionTime;
+        total.implicitTasks += profile->implicitTasks;
+        total.startupTime += profile->startupTime;
+        total.taskTime += profile->taskTime;
+        total.barrierWaitTime += profile->barrierWaitTime;
+        total.syncWaitTime += profile->syncWaitTime;
+        total.mutexWaitTime += profile->mutexWaitTime;
+        total.mutexAcquisitions += profile->mutexAcquisitions;
+        if (getWorkTime(profile) > maxWork)
+        {
+            maxWork = getWorkTime(profile);
+        }
+    }
+    if (numActive == 0)
+    {
+        return;
+    }
+    double meanWork = getWorkTime(&total) / numActive;
+    for (int t = 0; t < numProfiles; t++)
+    {
+        ThreadProfile *profile = profiles[t];
+        if (profile->implicitTasks == 0 && profile->regions == 0 && profile->mutexAcquisitions == 0)
+        {
+            continue;
+        }
+        char thread[16];
+        snprintf(thread, sizeof(thread), "%d", profile->threadNum);
+        printProfile(thread, profile->regions, profile->regionTime, profile->implicitTasks, profile->startupTime,
+                     getWorkTime(profile), profile->barrierWaitTime, profile->syncWaitTime, profile->mutexWaitTime,
+                     profile->mutexAcquisitions, meanWork > 0 ? getWorkTime(profile) / meanWork : 0);
+    }
+    printProfile("all", total.regions, total.regionTime, total.implicitTasks, total.startupTime,
+                 getWorkTime(&total), total.barrierWaitTime, total.syncWaitTime, total.mutexWaitTime,
+                 total.mutexAcquisitions, meanWork > 0 ? maxWork / meanWork : 0);
+    fflush(output);
+}
+
+static void resetProfiles()
+{
+    for (int t = 0; t < numProfiles; t++)
+    {
+        ThreadProfile *profile = profiles[t];
+        int threadNum = profile->threadNum;
+        memset(profile, 0, sizeof(ThreadProfile));
+        profile->threadNum = threadNum;
+    }
+    variantCalls = 0;
+}
+
+static int onControlTool(uint64_t command, uint64_t modifier, void *arg, const void *codeptr)
+{
+    switch (command)
+    {
+    case OMPT_PROFILER_START:
+        recording = 1;
+        variantCalls++;
+        return 0;
+    case OMPT_PROFILER_PAUSE:
+        recording = 0;
+        return 0;
+    case OMPT_PROFILER_FLUSH:
+        flushVariant();
+        resetProfiles();
+        return 0;
+    case OMPT_PROFILER_VARIANT:
+        flushVariant();
+        resetProfiles();
+        snprintf(variant, sizeof(variant), "%s", arg != NULL ? (const char *)arg : "unnamed");
+        recording = 0;
+        return 0;
+    default:
+        return -1;
+    }
+}
+
+static int initializeTool(ompt_function_lookup_t lookup, int initialDeviceNum, ompt_data_t *toolData)
+{
+    setCallback = (ompt_set_callback_t)lookup("ompt_set_callback");
+    if (setCallback == NULL)
+    {
+        return 0;
+    }
+
+    const char *path = getenv("OMPT_PROFILER_OUTPUT");
+    output = fopen(path != NULL ? path : "ompt_profile.csv", "w+");
+    if (output == NULL)
+    {
+        perror(path != NULL ? path : "ompt_profile.csv");
+        return 0;
+    }
+    fprintf(output, "variant;thread;calls;regions;region_time;implicit_tasks;startup_time;work_time;"
+                    "barrier_wait_time;sync_wait_time;mutex_wait_time;mutex_acquisitions;work_ratio\n");
+
+    setCallback(ompt_callback_thread_begin, (ompt_callback_t)onThreadBegin);
+    setCallback(ompt_callback_parallel_begin, (ompt_callback_t)onParallelBegin);
+    setCallback(ompt_callback_parallel_end, (ompt_callback_t)onParallelEnd);
+    setCallback(ompt_callback_implicit_task, (ompt_callback_t)onImplicitTask);
+    setCallback(ompt_callback_sync_region_wait, (ompt_callback_t)onSyncRegionWait);
+    setCallback(ompt_callback_mutex_acquire, (ompt_callback_t)onMutexAcquire);
+    setCallback(ompt_callback_mutex_acquired, (ompt_callback_t)onMutexAcquired);
+    setCallback(ompt_callback_control_tool, (ompt_callback_t)onControlTool);
+    return 1;
+}
+
+static void finalizeTool(ompt_data_t *toolData)
+{
+    flushVariant();
+    fclose(output);
+}
+
+ompt_start_tool_result_t *ompt_start_tool(unsigned int ompVersion, const char *runtimeVersion)
+{
+    static ompt_start_tool_result_t result = {.initialize = initializeTool, .finalize = finalizeTool};
+    return &result;
+}
@@ -0,0 +1,21 @@
+#ifndef OPENMP_OMPT_PROFILER_H
+#define OPENMP_OMPT_PROFILER_H
+#endif
+
+/*
+ * Commands understood by the OMPT profiler through omp_control_tool. The
+ * first three are the values of the standard omp_control_tool_start,
+ * omp_control_tool_pause and omp_control_tool_flush, which libgomp's omp.h
+ * does not declare: start and pause resume and suspend recording, flush
+ * writes what was recorded so far. OMPT_PROFILER_VARIANT writes the current
+ * variant and starts a new, paused one named by the string passed as arg.
+ *
+ * The tool is loaded by runtimes that implement OMPT (LLVM libomp, not
+ * GCC's libgomp), e.g.
+ *   LD_PRELOAD=libomp.so OMP_TOOL_LIBRARIES=./libomptProfiler.so ./openmp ...
+ * and writes to $OMPT_PROFILER_OUTPUT (default ompt_profile.csv).
+ */
+#define OMPT_PROFILER_START 1
+#define OMPT_PROFILER_PAUSE 2
+#define OMPT_PROFILER_FLUSH 3
+#define OMPT_PROFILER_VARIANT 64
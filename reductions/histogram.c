@@ -0,0 +1,334 @@
+#include "./histogram.h"
+#include "omp.h"
+#include "malloc.h"
+#include "string.h"
+#include "../utils/utils.h"
+#include "../benchmark/registry.h"
+
+#define PARTITION_BITS 15
+#define PARTITION_BUCKETS (1 << PARTITION_BITS)
+// The builtin array-section reduction keeps its private copies on the
+// thread stacks, so it is limited to tables that fit there comfortably.
+#define MAX_BUILTIN_BUCKETS (1 << 16)
+// Private tables cost numThreads * numBuckets ints; above this the
+// strategy is skipped instead of exhausting memory.
+#define MAX_PRIVATE_TABLES_BYTES (1LL << 30)
+
+/*
+ * Keyed count: histogram[bucket(key)] is the number of keys in array that
+ * fall into the bucket. Every variant overwrites all numBuckets counters.
+ */
+
+static inline int bucketOf(int key, int numBuckets)
+{
+    return (int)((unsigned int)key % (unsigned int)numBuckets);
+}
+
+static void getThreadRange(int length, int *start, int *end)
+{
+    int numThreads = omp_get_num_threads();
+    int threadNum = omp_get_thread_num();
+    int chunkSize = length / numThreads;
+    *start = threadNum * chunkSize;
+    *end = threadNum == numThreads - 1
+               ? length
+               : *start + chunkSize;
+}
+
+static void histogramSingleThread(int *array, int length, int numBuckets, int *histogram)
+{
+    memset(histogram, 0, sizeof(int) * numBuckets);
+    for (int i = 0; i < length; i++)
+    {
+        histogram[bucketOf(array[i], numBuckets)]++;
+    }
+}
+
+static void histogramAtomic(int *array, int length, int numBuckets, int *histogram)
+{
+    int i;
+#pragma omp parallel shared(array, length, numBuckets, histogram) private(i) default(none)
+    {
+#pragma omp for
+        for (i = 0; i < numBuckets; i++)
+        {
+            histogram[i] = 0;
+        }
+#pragma omp for
+        for (i = 0; i < length; i++)
+        {
+#pragma omp atomic
+            histogram[bucketOf(array[i], numBuckets)]++;
+        }
+    }
+}
+
+static void histogramBuiltin(int *array, int length, int numBuckets, int *histogram)
+{
+    int i;
+    memset(histogram, 0, sizeof(int) * numBuckets);
+#pragma omp parallel for shared(array, length, numBuckets) private(i) reduction(+ \
+                                                                            : histogram[:numBuckets])
+    for (i = 0; i < length; i++)
+    {
+        histogram[bucketOf(array[i], numBuckets)]++;
+    }
+}
+
+/*
+ * Every thread counts into its own full-size table, then the tables are
+ * merged with the buckets split between threads, so the merge is parallel
+ * and needs no synchronization.
+ */
+static void histogramPrivate(int *array, int length, int numBuckets, int *histogram)
+{
+    int *privateTables = malloc(sizeof(int) * (size_t)numBuckets * omp_get_max_threads());
+#pragma omp parallel shared(array, length, numBuckets, histogram, privateTables) default(none)
+    {
+        int numThreads = omp_get_num_threads();
+        int *table = privateTables + (size_t)omp_get_thread_num() * numBuckets;
+        int start, end;
+        getThreadRange(length, &start, &end);
+        memset(table, 0, sizeof(int) * numBuckets);
+        for (int i = start; i < end; i++)
+        {
+            table[bucketOf(array[i], numBuckets)]++;
+        }
+#pragma omp barrier
+#pragma omp for
+        for (int bucket = 0; bucket < numBuckets; bucket++)
+        {
+            int count = 0;
+            for (int t = 0; t < numThreads; t++)
+            {
+                count += privateTables[(size_t)t * numBuckets + bucket];
+            }
+            histogram[bucket] = count;
+        }
+    }
+    free(privateTables);
+}
+
+/*
+ * Radix partitioning for large key spaces: the buckets are cut into
+ * partitions of PARTITION_BUCKETS counters (an L2-sized slice of the
+ * table). Threads first scatter the bucket ids of their keys so that every
+ * partition is contiguous, then each partition is counted by exactly one
+ * thread straight into the shared histogram, without atomics or private
+ * copies of the table.
+ */
+static void histogramRadixPartitioned(int *array, int length, int numBuckets, int *histogram)
+{
+    const int numPartitions = (numBuckets + PARTITION_BUCKETS - 1) / PARTITION_BUCKETS;
+    int *offsets = malloc(sizeof(int) * (size_t)numPartitions * omp_get_max_threads());
+    int *partitionStarts = malloc(sizeof(int) * (numPartitions + 1));
+    int *scattered = malloc(sizeof(int) * (length > 0 ? length : 1));
+#pragma omp parallel shared(array, length, numBuckets, histogram, numPartitions, offsets, partitionStarts, scattered) default(none)
+    {
+        int numThreads = omp_get_num_threads();
+        int *threadOffsets = offsets + (size_t)omp_get_thread_num() * numPartitions;
+        int start, end;
+        getThreadRange(length, &start, &end);
+        memset(threadOffsets, 0, sizeof(int) * numPartitions);
+        for (int i = start; i < end; i++)
+        {
+            threadOffsets[bucketOf(array[i], numBuckets) >> PARTITION_BITS]++;
+        }
+#pragma omp barrier
+#pragma omp single
+        {
+            int running = 0;
+            for (int p = 0; p < numPartitions; p++)
+            {
+                partitionStarts[p] = running;
+                for (int t = 0; t < numThreads; t++)
+                {
+                    int count = offsets[(size_t)t * numPartitions + p];
+                    offsets[(size_t)t * numPartitions + p] = running;
+                    running += count;
+                }
+            }
+            partitionStarts[numPartitions] = running;
+        }
+        for (int i = start; i < end; i++)
+        {
+            int bucket = bucketOf(array[i], numBuckets);
+            scattered[threadOffsets[bucket >> PARTITION_BITS]++] = bucket;
+        }
+#pragma omp barrier
+#pragma omp for schedule(dynamic, 1)
+        for (int p = 0; p < numPartitions; p++)
+        {
+            int firstBucket = p << PARTITION_BITS;
+            int lastBucket = firstBucket + PARTITION_BUCKETS < numBuckets ? firstBucket + PARTITION_BUCKETS : numBuckets;
+            memset(histogram + firstBucket, 0, sizeof(int) * (lastBucket - firstBucket));
+            for (int j = partitionStarts[p]; j < partitionStarts[p + 1]; j++)
+            {
+                histogram[scattered[j]]++;
+            }
+        }
+    }
+    free(offsets);
+    free(partitionStarts);
+    free(scattered);
+}
+
+static double measure(void (*method)(int *, int, int, int *), int *array, int length, int numBuckets, int *histogram)
+{
+    double start = omp_get_wtime();
+    method(array, length, numBuckets, histogram);
+    double end = omp_get_wtime();
+    return (end - start) * 1000;
+}
+
+static void doHistogramMeasurement(const char *name, void (*method)(int *, int, int, int *), int *array, int length,
+                                   int numBuckets, int *histogram, const int *expected, int numThreads, FILE *file, FILE *errPath)
+{
+    fprintf(file, "%s;%d;%d;%d;%0.15f\n", name, numThreads, length, numBuckets,
+            measure(method, array, length, numBuckets, histogram));
+    if (memcmp(histogram, expected, sizeof(int) * numBuckets) != 0)
+    {
+        fprintf(errPath, "method = %s, threads = %d, length = %d, buckets = %d, histogram differs from single thread\n",
+                name, numThreads, length, numBuckets);
+    }
+}
+
+static void doTestCycle(int length, int numBuckets, FILE *file, FILE *errPath)
+{
+    int *testArray = malloc(sizeof(int) * length);
+    int *expected = malloc(sizeof(int) * numBuckets);
+    int *histogram = malloc(sizeof(int) * numBuckets);
+    FillWithRandomValues(length, testArray);
+
+    fprintf(file, "single;1;%d;%d;%0.15f\n", length, numBuckets,
+            measure(histogramSingleThread, testArray, length, numBuckets, expected));
+    const int maxThreads = omp_get_num_procs();
+    for (int numThreads = 2; numThreads < maxThreads * 2; numThreads++)
+    {
+        omp_set_num_threads(numThreads);
+        doHistogramMeasurement("atomic", histogramAtomic, testArray, length, numBuckets, histogram, expected, numThreads, file, errPath);
+        if (numBuckets <= MAX_BUILTIN_BUCKETS)
+        {
+            doHistogramMeasurement("builtin", histogramBuiltin, testArray, length, numBuckets, histogram, expected, numThreads, file, errPath);
+        }
+        if ((long long)numBuckets * numThreads * sizeof(int) <= MAX_PRIVATE_TABLES_BYTES)
+        {
+            doHistogramMeasurement("private", histogramPrivate, testArray, length, numBuckets, histogram, expected, numThreads, file, errPath);
+        }
+        doHistogramMeasurement("radix_partitioned", histogramRadixPartitioned, testArray, length, numBuckets, histogram, expected, numThreads, file, errPath);
+    }
+    free(testArray);
+    free(expected);
+    free(histogram);
+}
+
+int PerformHistogramComparison()
+{
+    FILE *file = fopen("../python_scripts/reductions/histogram.csv", "w+");
+    FILE *errPath = fopen("errPath.txt", "w+");
+    fprintf(file, "method;num_threads;length;num_buckets;elapsed_time\n");
+
+    const int bucketCounts[] = {16, 256, 4096, 65536, 1000000, 10000000};
+    for (int i = 0; i < 30; i++)
+    {
+        for (int b = 0; b < 6; b++)
+        {
+            doTestCycle(10000000, bucketCounts[b], file, errPath);
+        }
+    }
+    fclose(errPath);
+    fclose(file);
+    return 0;
+}
+
+typedef struct HistogramInput
+{
+    int *array;
+    int length;
+    int numBuckets;
+    int *histogram;
+} HistogramInput;
+
+static void *setupHistogram(int size, const void *parameters)
+{
+    HistogramInput *input = malloc(sizeof(HistogramInput));
+    input->array = malloc(sizeof(int) * size);
+    input->length = size;
+    input->numBuckets = *(const int *)parameters;
+    input->histogram = malloc(sizeof(int) * input->numBuckets);
+    FillWithRandomValues(size, input->array);
+    return input;
+}
+
+static void teardownHistogram(void *input)
+{
+    HistogramInput *h = input;
+    free(h->array);
+    free(h->histogram);
+    free(h);
+}
+
+static double runHistogram(void (*method)(int *, int, int, int *), HistogramInput *h)
+{
+    method(h->array, h->length, h->numBuckets, h->histogram);
+    return h->histogram[0];
+}
+
+static double runSingleThread(void *input)
+{
+    return runHistogram(histogramSingleThread, input);
+}
+
+static double runAtomic(void *input)
+{
+    return runHistogram(histogramAtomic, input);
+}
+
+static double runBuiltin(void *input)
+{
+    return runHistogram(histogramBuiltin, input);
+}
+
+static double runPrivate(void *input)
+{
+    return runHistogram(histogramPrivate, input);
+}
+
+static double runRadixPartitioned(void *input)
+{
+    return runHistogram(histogramRadixPartitioned, input);
+}
+
+// Keys are read once and the table is written once; the increments
+// themselves hit the cache when the table fits.
+static BenchmarkWork workHistogram(const void *input)
+{
+    const HistogramInput *h = input;
+    return (BenchmarkWork){.bytes = sizeof(int) * ((double)h->length + h->numBuckets), .operations = h->length};
+}
+
+static const int registeredBucketCounts[] = {16, 65536, 10000000};
+static const char *registeredGroupNames[] = {"histogram_16", "histogram_65536", "histogram_10000000"};
+
+void RegisterHistogramBenchmarks()
+{
+    for (int b = 0; b < 3; b++)
+    {
+        const BenchmarkGroup *group = RegisterBenchmarkGroup((BenchmarkGroup){
+            .name = registeredGroupNames[b],
+            .setup = setupHistogram,
+            .teardown = teardownHistogram,
+            .work = workHistogram,
+            .parameters = &registeredBucketCounts[b],
+            .numDefaultSizes = 2,
+            .defaultSizes = {100000, 10000000}});
+        RegisterBenchmark(group, "single", runSingleThread, 0);
+        RegisterBenchmark(group, "atomic", runAtomic, 1);
+        if (registeredBucketCounts[b] <= MAX_BUILTIN_BUCKETS)
+        {
+            RegisterBenchmark(group, "builtin", runBuiltin, 1);
+        }
+        RegisterBenchmark(group, "private", runPrivate, 1);
+        RegisterBenchmark(group, "radix_partitioned", runRadixPartitioned, 1);
+    }
+}
@@ -0,0 +1,5 @@
+
+int PerformHistogramComparison();
+
+void RegisterHistogramBenchmarks();
+
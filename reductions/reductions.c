@@ -1,7 +1,19 @@
 #include "./reductions.h"
 #include "omp.h"
 #include "malloc.h"
+#include "limits.h"
 #include "../utils/utils.h"
+#include "../locks/spinlocks.h"
+#include "../benchmark/registry.h"
+#include "../datatypes/hugePages.h"
+
+#define CACHE_LINE_SIZE 64
+
+typedef struct PaddedPartial
+{
+    int value;
+    char padding[CACHE_LINE_SIZE - sizeof(int)];
+} __attribute__((aligned(CACHE_LINE_SIZE))) PaddedPartial;
 
 static int arraySumReductionBuiltin(int *array, int length)
 {
@@ -93,8 +105,411 @@ static int arraySumReductionLocks(int *array, int length)
         total += sum;
         omp_unset_lock(&lock);
     }
-    return total;
     omp_destroy_lock(&lock);
+    return total;
+}
+
+static void getThreadRange(int length, int *start, int *end)
+{
+    int numThreads = omp_get_num_threads();
+    int threadNum = omp_get_thread_num();
+    int chunkSize = length / numThreads;
+    *start = threadNum * chunkSize;
+    *end = threadNum == numThreads - 1
+               ? length
+               : *start + chunkSize;
+}
+
+/*
+ * Pairwise tree combine: after round k every thread whose id is a multiple
+ * of 2^(k+1) holds the sum of 2^(k+1) partials, so slot 0 is final after
+ * ceil(log2 P) rounds instead of P serialized updates.
+ */
+static void combinePartialsTree(PaddedPartial *partials, int threadNum, int numThreads)
+{
+    for (int stride = 1; stride < numThreads; stride *= 2)
+    {
+#pragma omp barrier
+        if (threadNum % (2 * stride) == 0 && threadNum + stride < numThreads)
+        {
+            partials[threadNum].value += partials[threadNum + stride].value;
+        }
+    }
+}
+
+/*
+ * Recursive-doubling butterfly: threads above the largest power of two fold
+ * into a partner first, then every remaining thread exchanges with
+ * threadNum ^ stride. Two buffers avoid reading a slot that is being
+ * overwritten in the same round; every thread ends with the total.
+ */
+static int combinePartialsButterfly(PaddedPartial *current, PaddedPartial *next, int threadNum, int numThreads)
+{
+    int powerOfTwo = 1;
+    while (powerOfTwo * 2 <= numThreads)
+    {
+        powerOfTwo *= 2;
+    }
+#pragma omp barrier
+    if (threadNum >= powerOfTwo)
+    {
+        current[threadNum - powerOfTwo].value += current[threadNum].value;
+    }
+    for (int stride = 1; stride < powerOfTwo; stride *= 2)
+    {
+#pragma omp barrier
+        if (threadNum < powerOfTwo)
+        {
+            next[threadNum].value = current[threadNum].value + current[threadNum ^ stride].value;
+        }
+        PaddedPartial *swap = current;
+        current = next;
+        next = swap;
+    }
+#pragma omp barrier
+    return current[threadNum < powerOfTwo ? threadNum : 0].value;
+}
+
+static int arraySumReductionPaddedTree(int *array, int length)
+{
+    PaddedPartial *partials = memalign(CACHE_LINE_SIZE, sizeof(PaddedPartial) * omp_get_max_threads());
+#pragma omp parallel shared(array, length, partials) default(none)
+    {
+        int threadNum = omp_get_thread_num();
+        int start, end;
+        getThreadRange(length, &start, &end);
+        partials[threadNum].value = 0;
+        for (int i = start; i < end; i++)
+        {
+            partials[threadNum].value += array[i];
+        }
+        combinePartialsTree(partials, threadNum, omp_get_num_threads());
+    }
+    int total = partials[0].value;
+    free(partials);
+    return total;
+}
+
+static int arraySumReductionPaddedButterfly(int *array, int length)
+{
+    const int maxThreads = omp_get_max_threads();
+    PaddedPartial *partials = memalign(CACHE_LINE_SIZE, sizeof(PaddedPartial) * maxThreads * 2);
+    int total = 0;
+#pragma omp parallel shared(array, length, partials, maxThreads, total) default(none)
+    {
+        int threadNum = omp_get_thread_num();
+        int start, end;
+        getThreadRange(length, &start, &end);
+        partials[threadNum].value = 0;
+        for (int i = start; i < end; i++)
+        {
+            partials[threadNum].value += array[i];
+        }
+        int sum = combinePartialsButterfly(partials, partials + maxThreads, threadNum, omp_get_num_threads());
+        if (threadNum == 0)
+        {
+            total = sum;
+        }
+    }
+    free(partials);
+    return total;
+}
+
+// Same accumulation pattern as arraySumReductionPaddedTree, but neighbouring
+// partials share cache lines, so the difference between the two is the
+// false-sharing penalty.
+static int arraySumReductionUnpadded(int *array, int length)
+{
+    int *partials = malloc(sizeof(int) * omp_get_max_threads());
+    int numThreads = 1;
+#pragma omp parallel shared(array, length, partials, numThreads) default(none)
+    {
+        int threadNum = omp_get_thread_num();
+        int start, end;
+        getThreadRange(length, &start, &end);
+        partials[threadNum] = 0;
+        for (int i = start; i < end; i++)
+        {
+            partials[threadNum] += array[i];
+        }
+        if (threadNum == 0)
+        {
+            numThreads = omp_get_num_threads();
+        }
+    }
+    int total = 0;
+    for (int i = 0; i < numThreads; i++)
+    {
+        total += partials[i];
+    }
+    free(partials);
+    return total;
+}
+
+static LockKind reductionLockKind = LOCK_TTAS;
+
+static int arraySumReductionSpinLock(int *array, int length)
+{
+    int total = 0;
+    SpinLock *lock = InitSpinLock(reductionLockKind, omp_get_max_threads());
+#pragma omp parallel shared(array, length, total, lock) default(none)
+    {
+        int sum = 0;
+        int start, end;
+        getThreadRange(length, &start, &end);
+        for (int i = start; i < end; i++)
+        {
+            sum += array[i];
+        }
+        AcquireSpinLock(lock, omp_get_thread_num());
+        total += sum;
+        ReleaseSpinLock(lock, omp_get_thread_num());
+    }
+    FreeSpinLock(lock);
+    return total;
+}
+
+/*
+ * Divide-and-conquer variants: a range is halved until it has at most
+ * taskLeafSize elements, so idle threads steal the remaining halves instead
+ * of waiting on a static chunk that straggles. The *Tasks functions combine
+ * the two halves after a taskwait; the *TaskGroup functions open a
+ * taskgroup with a task_reduction on every level and let both halves
+ * contribute through in_reduction.
+ */
+static int taskLeafSize = 4096;
+
+static int sumTasks(int *array, int length)
+{
+    int sum = 0;
+    if (length <= taskLeafSize)
+    {
+        for (int i = 0; i < length; i++)
+        {
+            sum += array[i];
+        }
+        return sum;
+    }
+    int half = length / 2;
+    int left;
+#pragma omp task shared(left) firstprivate(array, half) default(none)
+    left = sumTasks(array, half);
+    sum = sumTasks(array + half, length - half);
+#pragma omp taskwait
+    return left + sum;
+}
+
+static int sumTaskGroup(int *array, int length)
+{
+    int sum = 0;
+    if (length <= taskLeafSize)
+    {
+        for (int i = 0; i < length; i++)
+        {
+            sum += array[i];
+        }
+        return sum;
+    }
+    int half = length / 2;
+#pragma omp taskgroup task_reduction(+ \
+                                     : sum)
+    {
+#pragma omp task in_reduction(+ \
+                              : sum) firstprivate(array, half) default(none)
+        sum += sumTaskGroup(array, half);
+#pragma omp task in_reduction(+ \
+                              : sum) firstprivate(array, length, half) default(none)
+        sum += sumTaskGroup(array + half, length - half);
+    }
+    return sum;
+}
+
+static int minTasks(int *array, int length)
+{
+    int minVal = INT_MAX;
+    if (length <= taskLeafSize)
+    {
+        for (int i = 0; i < length; i++)
+        {
+            minVal = array[i] < minVal ? array[i] : minVal;
+        }
+        return minVal;
+    }
+    int half = length / 2;
+    int left;
+#pragma omp task shared(left) firstprivate(array, half) default(none)
+    left = minTasks(array, half);
+    minVal = minTasks(array + half, length - half);
+#pragma omp taskwait
+    return left < minVal ? left : minVal;
+}
+
+static int minTaskGroup(int *array, int length)
+{
+    int minVal = INT_MAX;
+    if (length <= taskLeafSize)
+    {
+        for (int i = 0; i < length; i++)
+        {
+            minVal = array[i] < minVal ? array[i] : minVal;
+        }
+        return minVal;
+    }
+    int half = length / 2;
+#pragma omp taskgroup task_reduction(min \
+                                     : minVal)
+    {
+#pragma omp task in_reduction(min \
+                              : minVal) firstprivate(array, half) default(none)
+        {
+            int left = minTaskGroup(array, half);
+            minVal = left < minVal ? left : minVal;
+        }
+#pragma omp task in_reduction(min \
+                              : minVal) firstprivate(array, length, half) default(none)
+        {
+            int right = minTaskGroup(array + half, length - half);
+            minVal = right < minVal ? right : minVal;
+        }
+    }
+    return minVal;
+}
+
+static int dotTasks(int *a, int *b, int length)
+{
+    int sum = 0;
+    if (length <= taskLeafSize)
+    {
+        for (int i = 0; i < length; i++)
+        {
+            sum += a[i] * b[i];
+        }
+        return sum;
+    }
+    int half = length / 2;
+    int left;
+#pragma omp task shared(left) firstprivate(a, b, half) default(none)
+    left = dotTasks(a, b, half);
+    sum = dotTasks(a + half, b + half, length - half);
+#pragma omp taskwait
+    return left + sum;
+}
+
+static int dotTaskGroup(int *a, int *b, int length)
+{
+    int sum = 0;
+    if (length <= taskLeafSize)
+    {
+        for (int i = 0; i < length; i++)
+        {
+            sum += a[i] * b[i];
+        }
+        return sum;
+    }
+    int half = length / 2;
+#pragma omp taskgroup task_reduction(+ \
+                                     : sum)
+    {
+#pragma omp task in_reduction(+ \
+                              : sum) firstprivate(a, b, half) default(none)
+        sum += dotTaskGroup(a, b, half);
+#pragma omp task in_reduction(+ \
+                              : sum) firstprivate(a, b, length, half) default(none)
+        sum += dotTaskGroup(a + half, b + half, length - half);
+    }
+    return sum;
+}
+
+static int arraySumReductionTasks(int *array, int length)
+{
+    int total = 0;
+#pragma omp parallel shared(array, length, total) default(none)
+    {
+#pragma omp single
+        total = sumTasks(array, length);
+    }
+    return total;
+}
+
+static int arraySumReductionTaskGroup(int *array, int length)
+{
+    int total = 0;
+#pragma omp parallel shared(array, length, total) default(none)
+    {
+#pragma omp single
+        total = sumTaskGroup(array, length);
+    }
+    return total;
+}
+
+static int arrayMinReductionBuiltin(int *array, int length)
+{
+    int minVal = INT_MAX;
+    int i;
+#pragma omp parallel for shared(array, length) private(i) reduction(min \
+                                                                    : minVal)
+    for (i = 0; i < length; i++)
+    {
+        minVal = array[i] < minVal ? array[i] : minVal;
+    }
+    return minVal;
+}
+
+static int arrayMinReductionTasks(int *array, int length)
+{
+    int minVal = INT_MAX;
+#pragma omp parallel shared(array, length, minVal) default(none)
+    {
+#pragma omp single
+        minVal = minTasks(array, length);
+    }
+    return minVal;
+}
+
+static int arrayMinReductionTaskGroup(int *array, int length)
+{
+    int minVal = INT_MAX;
+#pragma omp parallel shared(array, length, minVal) default(none)
+    {
+#pragma omp single
+        minVal = minTaskGroup(array, length);
+    }
+    return minVal;
+}
+
+static int dotReductionBuiltin(int *a, int *b, int length)
+{
+    int sum = 0;
+    int i;
+#pragma omp parallel for shared(a, b, length) private(i) reduction(+ \
+                                                                   : sum)
+    for (i = 0; i < length; i++)
+    {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+static int dotReductionTasks(int *a, int *b, int length)
+{
+    int total = 0;
+#pragma omp parallel shared(a, b, length, total) default(none)
+    {
+#pragma omp single
+        total = dotTasks(a, b, length);
+    }
+    return total;
+}
+
+static int dotReductionTaskGroup(int *a, int *b, int length)
+{
+    int total = 0;
+#pragma omp parallel shared(a, b, length, total) default(none)
+    {
+#pragma omp single
+        total = dotTaskGroup(a, b, length);
+    }
+    return total;
 }
 
 static void performTest()
@@ -107,6 +522,11 @@ static void performTest()
     int critical = arraySumReductionCritical(testArray, arrSize);
     int atomic = arraySumReductionAtomics(testArray, arrSize);
     int lock = arraySumReductionLocks(testArray, arrSize);
+    int paddedTree = arraySumReductionPaddedTree(testArray, arrSize);
+    int paddedButterfly = arraySumReductionPaddedButterfly(testArray, arrSize);
+    int unpadded = arraySumReductionUnpadded(testArray, arrSize);
+    int tasks = arraySumReductionTasks(testArray, arrSize);
+    int taskGroup = arraySumReductionTaskGroup(testArray, arrSize);
 
     printf("red = %d\n", reduction);
     printf("crit = %d\n", critical);
@@ -116,6 +536,21 @@ static void performTest()
     printf("red - crit = %d\n", reduction - critical);
     printf("red - atomic = %d\n", reduction - atomic);
     printf("red - lock = %d\n", reduction - lock);
+    printf("red - padded_tree = %d\n", reduction - paddedTree);
+    printf("red - padded_butterfly = %d\n", reduction - paddedButterfly);
+    printf("red - unpadded = %d\n", reduction - unpadded);
+    printf("red - tasks = %d\n", reduction - tasks);
+    printf("red - task_group = %d\n", reduction - taskGroup);
+    printf("min - min_tasks = %d\n", arrayMinReductionBuiltin(testArray, arrSize) - arrayMinReductionTasks(testArray, arrSize));
+    printf("min - min_task_group = %d\n", arrayMinReductionBuiltin(testArray, arrSize) - arrayMinReductionTaskGroup(testArray, arrSize));
+    printf("dot - dot_tasks = %d\n", dotReductionBuiltin(testArray, testArray, arrSize) - dotReductionTasks(testArray, testArray, arrSize));
+    printf("dot - dot_task_group = %d\n", dotReductionBuiltin(testArray, testArray, arrSize) - dotReductionTaskGroup(testArray, testArray, arrSize));
+    for (LockKind kind = 0; kind < LOCK_KIND_COUNT; kind++)
+    {
+        reductionLockKind = kind;
+        printf("red - lock_%s = %d\n", GetLockKindName(kind),
+               reduction - arraySumReductionSpinLock(testArray, arrSize));
+    }
 }
 
 static double measure(int (*method)(int *, int), int *array, int length)
@@ -126,10 +561,20 @@ static double measure(int (*method)(int *, int), int *array, int length)
     return (end - start) * 1000;
 }
 
+static double measureDot(int (*method)(int *, int *, int), int *a, int *b, int length)
+{
+    double start = omp_get_wtime();
+    method(a, b, length);
+    double end = omp_get_wtime();
+    return (end - start) * 1000;
+}
+
 static void doTestCycle(int length, FILE *file)
 {
     int *testArray = malloc(sizeof(int) * length);
+    int *secondArray = malloc(sizeof(int) * length);
     FillWithRandomValues(length, testArray);
+    FillWithRandomValues(length, secondArray);
     const int maxThreads = omp_get_num_procs();
 
     for (int numThreads = 2; numThreads < maxThreads * 2; numThreads++)
@@ -139,8 +584,26 @@ static void doTestCycle(int length, FILE *file)
         fprintf(file, "critical;%d;%d;%0.15f\n", numThreads, length, measure(arraySumReductionCritical, testArray, length));
         fprintf(file, "atomics;%d;%d;%0.15f\n", numThreads, length, measure(arraySumReductionAtomics, testArray, length));
         fprintf(file, "locks;%d;%d;%0.15f\n", numThreads, length, measure(arraySumReductionLocks, testArray, length));
+        fprintf(file, "padded_tree;%d;%d;%0.15f\n", numThreads, length, measure(arraySumReductionPaddedTree, testArray, length));
+        fprintf(file, "padded_butterfly;%d;%d;%0.15f\n", numThreads, length, measure(arraySumReductionPaddedButterfly, testArray, length));
+        fprintf(file, "unpadded;%d;%d;%0.15f\n", numThreads, length, measure(arraySumReductionUnpadded, testArray, length));
+        fprintf(file, "tasks;%d;%d;%0.15f\n", numThreads, length, measure(arraySumReductionTasks, testArray, length));
+        fprintf(file, "task_group;%d;%d;%0.15f\n", numThreads, length, measure(arraySumReductionTaskGroup, testArray, length));
+        fprintf(file, "min_builtin;%d;%d;%0.15f\n", numThreads, length, measure(arrayMinReductionBuiltin, testArray, length));
+        fprintf(file, "min_tasks;%d;%d;%0.15f\n", numThreads, length, measure(arrayMinReductionTasks, testArray, length));
+        fprintf(file, "min_task_group;%d;%d;%0.15f\n", numThreads, length, measure(arrayMinReductionTaskGroup, testArray, length));
+        fprintf(file, "dot_builtin;%d;%d;%0.15f\n", numThreads, length, measureDot(dotReductionBuiltin, testArray, secondArray, length));
+        fprintf(file, "dot_tasks;%d;%d;%0.15f\n", numThreads, length, measureDot(dotReductionTasks, testArray, secondArray, length));
+        fprintf(file, "dot_task_group;%d;%d;%0.15f\n", numThreads, length, measureDot(dotReductionTaskGroup, testArray, secondArray, length));
+        for (LockKind kind = 0; kind < LOCK_KIND_COUNT; kind++)
+        {
+            reductionLockKind = kind;
+            fprintf(file, "lock_%s;%d;%d;%0.15f\n", GetLockKindName(kind), numThreads, length,
+                    measure(arraySumReductionSpinLock, testArray, length));
+        }
     }
     free(testArray);
+    free(secondArray);
 }
 int performReductionsComparison()
 {
@@ -155,4 +618,251 @@ int performReductionsComparison()
     }
     fclose(file);
     return 0;
-}
\ No newline at end of file
+}
+
+typedef struct ReductionInput
+{
+    int *array;
+    // Second operand of the dot groups, NULL otherwise.
+    int *second;
+    int length;
+} ReductionInput;
+
+typedef struct ReductionParameters
+{
+    int numOperands;
+} ReductionParameters;
+
+static const ReductionParameters dotParameters = {.numOperands = 2};
+
+static void *setupReduction(int size, const void *parameters)
+{
+    ReductionInput *input = malloc(sizeof(ReductionInput));
+    input->array = AllocatePages(sizeof(int) * size);
+    input->second = NULL;
+    input->length = size;
+    FillWithRandomValues(size, input->array);
+    const ReductionParameters *reduction = parameters;
+    if (reduction != NULL && reduction->numOperands == 2)
+    {
+        input->second = AllocatePages(sizeof(int) * size);
+        FillWithRandomValues(size, input->second);
+    }
+    return input;
+}
+
+static void teardownReduction(void *input)
+{
+    ReductionInput *reduction = input;
+    FreePages(reduction->array);
+    if (reduction->second != NULL)
+    {
+        FreePages(reduction->second);
+    }
+    free(reduction);
+}
+
+static double runBuiltin(void *input)
+{
+    ReductionInput *r = input;
+    return arraySumReductionBuiltin(r->array, r->length);
+}
+
+static double runCritical(void *input)
+{
+    ReductionInput *r = input;
+    return arraySumReductionCritical(r->array, r->length);
+}
+
+static double runAtomics(void *input)
+{
+    ReductionInput *r = input;
+    return arraySumReductionAtomics(r->array, r->length);
+}
+
+static double runLocks(void *input)
+{
+    ReductionInput *r = input;
+    return arraySumReductionLocks(r->array, r->length);
+}
+
+static double runPaddedTree(void *input)
+{
+    ReductionInput *r = input;
+    return arraySumReductionPaddedTree(r->array, r->length);
+}
+
+static double runPaddedButterfly(void *input)
+{
+    ReductionInput *r = input;
+    return arraySumReductionPaddedButterfly(r->array, r->length);
+}
+
+static double runUnpadded(void *input)
+{
+    ReductionInput *r = input;
+    return arraySumReductionUnpadded(r->array, r->length);
+}
+
+static double runSpinLock(void *input, LockKind kind)
+{
+    ReductionInput *r = input;
+    reductionLockKind = kind;
+    return arraySumReductionSpinLock(r->array, r->length);
+}
+
+static double runLockOmp(void *input)
+{
+    return runSpinLock(input, LOCK_OMP);
+}
+
+static double runLockTTAS(void *input)
+{
+    return runSpinLock(input, LOCK_TTAS);
+}
+
+static double runLockTicket(void *input)
+{
+    return runSpinLock(input, LOCK_TICKET);
+}
+
+static double runLockMCS(void *input)
+{
+    return runSpinLock(input, LOCK_MCS);
+}
+
+static double runLockCLH(void *input)
+{
+    return runSpinLock(input, LOCK_CLH);
+}
+
+static double runTasksWithLeaf(void *input, int leafSize)
+{
+    ReductionInput *r = input;
+    taskLeafSize = leafSize;
+    return arraySumReductionTasks(r->array, r->length);
+}
+
+static double runTasks(void *input)
+{
+    return runTasksWithLeaf(input, 4096);
+}
+
+static double runTasksLeaf512(void *input)
+{
+    return runTasksWithLeaf(input, 512);
+}
+
+static double runTasksLeaf65536(void *input)
+{
+    return runTasksWithLeaf(input, 65536);
+}
+
+static double runTaskGroup(void *input)
+{
+    ReductionInput *r = input;
+    taskLeafSize = 4096;
+    return arraySumReductionTaskGroup(r->array, r->length);
+}
+
+static double runMinBuiltin(void *input)
+{
+    ReductionInput *r = input;
+    return arrayMinReductionBuiltin(r->array, r->length);
+}
+
+static double runMinTasks(void *input)
+{
+    ReductionInput *r = input;
+    taskLeafSize = 4096;
+    return arrayMinReductionTasks(r->array, r->length);
+}
+
+static double runMinTaskGroup(void *input)
+{
+    ReductionInput *r = input;
+    taskLeafSize = 4096;
+    return arrayMinReductionTaskGroup(r->array, r->length);
+}
+
+static double runDotBuiltin(void *input)
+{
+    ReductionInput *r = input;
+    return dotReductionBuiltin(r->array, r->second, r->length);
+}
+
+static double runDotTasks(void *input)
+{
+    ReductionInput *r = input;
+    taskLeafSize = 4096;
+    return dotReductionTasks(r->array, r->second, r->length);
+}
+
+static double runDotTaskGroup(void *input)
+{
+    ReductionInput *r = input;
+    taskLeafSize = 4096;
+    return dotReductionTaskGroup(r->array, r->second, r->length);
+}
+
+static BenchmarkWork workReduction(const void *input)
+{
+    const ReductionInput *reduction = input;
+    return (BenchmarkWork){.bytes = sizeof(int) * (double)reduction->length, .operations = reduction->length};
+}
+
+static BenchmarkWork workDot(const void *input)
+{
+    const ReductionInput *reduction = input;
+    return (BenchmarkWork){.bytes = 2.0 * sizeof(int) * reduction->length, .operations = 2.0 * reduction->length};
+}
+
+void RegisterReductionsBenchmarks()
+{
+    const BenchmarkGroup *group = RegisterBenchmarkGroup((BenchmarkGroup){
+        .name = "reductions",
+        .setup = setupReduction,
+        .teardown = teardownReduction,
+        .work = workReduction,
+        .numDefaultSizes = 3,
+        .defaultSizes = {100, 10000, 1000000}});
+    RegisterBenchmark(group, "builtin", runBuiltin, 1);
+    RegisterBenchmark(group, "critical", runCritical, 1);
+    RegisterBenchmark(group, "atomics", runAtomics, 1);
+    RegisterBenchmark(group, "locks", runLocks, 1);
+    RegisterBenchmark(group, "padded_tree", runPaddedTree, 1);
+    RegisterBenchmark(group, "padded_butterfly", runPaddedButterfly, 1);
+    RegisterBenchmark(group, "unpadded", runUnpadded, 1);
+    RegisterBenchmark(group, "lock_omp", runLockOmp, 1);
+    RegisterBenchmark(group, "lock_ttas", runLockTTAS, 1);
+    RegisterBenchmark(group, "lock_ticket", runLockTicket, 1);
+    RegisterBenchmark(group, "lock_mcs", runLockMCS, 1);
+    RegisterBenchmark(group, "lock_clh", runLockCLH, 1);
+    RegisterBenchmark(group, "tasks", runTasks, 1);
+    RegisterBenchmark(group, "tasks_leaf_512", runTasksLeaf512, 1);
+    RegisterBenchmark(group, "tasks_leaf_65536", runTasksLeaf65536, 1);
+    RegisterBenchmark(group, "task_group", runTaskGroup, 1);
+
+    group = RegisterBenchmarkGroup((BenchmarkGroup){
+        .name = "reductions_min",
+        .setup = setupReduction,
+        .teardown = teardownReduction,
+        .work = workReduction,
+        .numDefaultSizes = 3,
+        .defaultSizes = {100, 10000, 1000000}});
+    RegisterBenchmark(group, "builtin", runMinBuiltin, 1);
+    RegisterBenchmark(group, "tasks", runMinTasks, 1);
+    RegisterBenchmark(group, "task_group", runMinTaskGroup, 1);
+
+    group = RegisterBenchmarkGroup((BenchmarkGroup){
+        .name = "reductions_dot",
+        .setup = setupReduction,
+        .teardown = teardownReduction,
+        .work = workDot,
+        .parameters = &dotParameters,
+        .numDefaultSizes = 3,
+        .defaultSizes = {100, 10000, 1000000}});
+    RegisterBenchmark(group, "builtin", runDotBuiltin, 1);
+    RegisterBenchmark(group, "tasks", runDotTasks, 1);
+    RegisterBenchmark(group, "task_group", runDotTaskGroup, 1);
+}
@@ -1,2 +1,4 @@
 
-int performReductionsComparison();
\ No newline at end of file
+int performReductionsComparison();
+
+void RegisterReductionsBenchmarks();
@@ -0,0 +1,433 @@
+#include "./scan.h"
+#include "omp.h"
+#include "malloc.h"
+#include "string.h"
+#include "../utils/utils.h"
+#include "../benchmark/registry.h"
+
+#define CACHE_LINE_SIZE 64
+#define SCAN_TILE_SIZE 16384
+#define EXCLUSIVE_STAGE_SIZE 1024
+
+#define TILE_NOT_READY 0
+#define TILE_AGGREGATE 1
+#define TILE_PREFIX 2
+
+/*
+ * All scans below work in place on (int *array, int length), the signature
+ * of the reductions harness, and return the sum of the whole array.
+ */
+
+typedef struct TileStatus
+{
+    // flag in the high word, value in the low word, so both are published
+    // with one atomic store.
+    long long state;
+} __attribute__((aligned(CACHE_LINE_SIZE))) TileStatus;
+
+static void getThreadRange(int length, int *start, int *end)
+{
+    int numThreads = omp_get_num_threads();
+    int threadNum = omp_get_thread_num();
+    int chunkSize = length / numThreads;
+    *start = threadNum * chunkSize;
+    *end = threadNum == numThreads - 1
+               ? length
+               : *start + chunkSize;
+}
+
+static int sumBlock(const int *array, int start, int end)
+{
+    int sum = 0;
+#pragma omp simd reduction(+ \
+                           : sum)
+    for (int i = start; i < end; i++)
+    {
+        sum += array[i];
+    }
+    return sum;
+}
+
+static int scanBlockInclusive(int *array, int start, int end, int offset)
+{
+    int running = offset;
+#pragma omp simd reduction(inscan, + \
+                           : running)
+    for (int i = start; i < end; i++)
+    {
+        running += array[i];
+#pragma omp scan inclusive(running)
+        array[i] = running;
+    }
+    return running;
+}
+
+// An exclusive scan writes array[i] before it reads it, so the input is
+// staged through an L1-sized buffer to keep the simd scan phases independent.
+static int scanBlockExclusive(int *array, int start, int end, int offset)
+{
+    int stage[EXCLUSIVE_STAGE_SIZE];
+    int running = offset;
+    for (int stageStart = start; stageStart < end; stageStart += EXCLUSIVE_STAGE_SIZE)
+    {
+        int stageLength = end - stageStart < EXCLUSIVE_STAGE_SIZE ? end - stageStart : EXCLUSIVE_STAGE_SIZE;
+        int *out = array + stageStart;
+        memcpy(stage, out, sizeof(int) * stageLength);
+#pragma omp simd reduction(inscan, + \
+                           : running)
+        for (int i = 0; i < stageLength; i++)
+        {
+            out[i] = running;
+#pragma omp scan exclusive(running)
+            running += stage[i];
+        }
+    }
+    return running;
+}
+
+static int scanBlock(int *array, int start, int end, int offset, int exclusive)
+{
+    return exclusive
+               ? scanBlockExclusive(array, start, end, offset)
+               : scanBlockInclusive(array, start, end, offset);
+}
+
+static int scanSingleThread(int *array, int length, int exclusive)
+{
+    int running = 0;
+    for (int i = 0; i < length; i++)
+    {
+        int value = array[i];
+        array[i] = exclusive ? running : running + value;
+        running += value;
+    }
+    return running;
+}
+
+static int inclusiveScanSingleThread(int *array, int length)
+{
+    return scanSingleThread(array, length, 0);
+}
+
+static int exclusiveScanSingleThread(int *array, int length)
+{
+    return scanSingleThread(array, length, 1);
+}
+
+static int inclusiveScanBuiltin(int *array, int length)
+{
+    int running = 0;
+    int i;
+#pragma omp parallel for simd shared(array, length) private(i) reduction(inscan, + \
+                                                                         : running)
+    for (i = 0; i < length; i++)
+    {
+        running += array[i];
+#pragma omp scan inclusive(running)
+        array[i] = running;
+    }
+    return running;
+}
+
+/*
+ * Reduce-then-scan: every thread sums its block, one thread scans the P
+ * block sums, then every thread rescans its block starting from its offset.
+ * The array is read twice and written once.
+ */
+static int scanTwoPass(int *array, int length, int exclusive)
+{
+    int *blockOffsets = malloc(sizeof(int) * (omp_get_max_threads() + 1));
+    int total = 0;
+#pragma omp parallel shared(array, length, exclusive, blockOffsets, total) default(none)
+    {
+        int threadNum = omp_get_thread_num();
+        int start, end;
+        getThreadRange(length, &start, &end);
+        blockOffsets[threadNum + 1] = sumBlock(array, start, end);
+#pragma omp barrier
+#pragma omp single
+        {
+            int numThreads = omp_get_num_threads();
+            blockOffsets[0] = 0;
+            for (int i = 1; i <= numThreads; i++)
+            {
+                blockOffsets[i] += blockOffsets[i - 1];
+            }
+            total = blockOffsets[numThreads];
+        }
+        scanBlock(array, start, end, blockOffsets[threadNum], exclusive);
+    }
+    free(blockOffsets);
+    return total;
+}
+
+static int inclusiveScanTwoPass(int *array, int length)
+{
+    return scanTwoPass(array, length, 0);
+}
+
+static int exclusiveScanTwoPass(int *array, int length)
+{
+    return scanTwoPass(array, length, 1);
+}
+
+static void publishTile(TileStatus *status, int flag, int value)
+{
+    long long state = ((long long)flag << 32) | (unsigned int)value;
+    __atomic_store_n(&status->state, state, __ATOMIC_RELEASE);
+}
+
+/*
+ * Single-pass scan with decoupled look-back. Tiles are claimed in order from
+ * a shared counter; each tile publishes its aggregate, then walks back over
+ * its predecessors adding aggregates until it meets a published inclusive
+ * prefix. Tiles fit in L2, so the array is streamed from memory only once.
+ */
+static int scanDecoupledLookBack(int *array, int length, int exclusive)
+{
+    const int numTiles = (length + SCAN_TILE_SIZE - 1) / SCAN_TILE_SIZE;
+    TileStatus *statuses = memalign(CACHE_LINE_SIZE, sizeof(TileStatus) * (numTiles > 0 ? numTiles : 1));
+    memset(statuses, 0, sizeof(TileStatus) * numTiles);
+    int nextTile = 0;
+    int total = 0;
+#pragma omp parallel shared(array, length, exclusive, statuses, numTiles, nextTile, total) default(none)
+    {
+        for (;;)
+        {
+            int tile = __atomic_fetch_add(&nextTile, 1, __ATOMIC_RELAXED);
+            if (tile >= numTiles)
+            {
+                break;
+            }
+            int start = tile * SCAN_TILE_SIZE;
+            int end = start + SCAN_TILE_SIZE < length ? start + SCAN_TILE_SIZE : length;
+            int aggregate = sumBlock(array, start, end);
+            int prefix = 0;
+            if (tile == 0)
+            {
+                publishTile(&statuses[tile], TILE_PREFIX, aggregate);
+            }
+            else
+            {
+                publishTile(&statuses[tile], TILE_AGGREGATE, aggregate);
+                for (int look = tile - 1;;)
+                {
+                    long long state = __atomic_load_n(&statuses[look].state, __ATOMIC_ACQUIRE);
+                    int flag = (int)(state >> 32);
+                    if (flag == TILE_NOT_READY)
+                    {
+                        continue;
+                    }
+                    prefix += (int)(unsigned int)state;
+                    if (flag == TILE_PREFIX)
+                    {
+                        break;
+                    }
+                    look--;
+                }
+                publishTile(&statuses[tile], TILE_PREFIX, prefix + aggregate);
+            }
+            scanBlock(array, start, end, prefix, exclusive);
+            if (tile == numTiles - 1)
+            {
+                total = prefix + aggregate;
+            }
+        }
+    }
+    free(statuses);
+    return total;
+}
+
+static int inclusiveScanDecoupledLookBack(int *array, int length)
+{
+    return scanDecoupledLookBack(array, length, 0);
+}
+
+static int exclusiveScanDecoupledLookBack(int *array, int length)
+{
+    return scanDecoupledLookBack(array, length, 1);
+}
+
+typedef struct ScanResult
+{
+    int total;
+    double elapsedTime;
+} ScanResult;
+
+static ScanResult measure(int (*method)(int *, int), int *array, int length)
+{
+    double start = omp_get_wtime();
+    int total = method(array, length);
+    double end = omp_get_wtime();
+    return (ScanResult){.total = total, .elapsedTime = (end - start) * 1000};
+}
+
+// Minimum traffic of an in-place scan: every element read once and written once.
+static double bandwidth(int length, double elapsedTime)
+{
+    return 2.0 * sizeof(int) * length / (elapsedTime * 1e6);
+}
+
+static void doScanMeasurement(const char *name, int (*method)(int *, int), const int *input, const int *expected,
+                              int *work, int length, int numThreads, FILE *file, FILE *errPath)
+{
+    memcpy(work, input, sizeof(int) * length);
+    ScanResult result = measure(method, work, length);
+    fprintf(file, "%s;%d;%d;%0.15f;%0.6f\n", name, numThreads, length, result.elapsedTime,
+            bandwidth(length, result.elapsedTime));
+    if (memcmp(work, expected, sizeof(int) * length) != 0)
+    {
+        fprintf(errPath, "method = %s, threads = %d, length = %d, scan differs from single thread\n",
+                name, numThreads, length);
+    }
+}
+
+static void doTestCycle(int length, FILE *file, FILE *errPath)
+{
+    int *input = malloc(sizeof(int) * length);
+    int *inclusive = malloc(sizeof(int) * length);
+    int *exclusive = malloc(sizeof(int) * length);
+    int *work = malloc(sizeof(int) * length);
+    FillWithRandomValues(length, input);
+
+    memcpy(inclusive, input, sizeof(int) * length);
+    ScanResult single = measure(inclusiveScanSingleThread, inclusive, length);
+    fprintf(file, "inclusive_single;1;%d;%0.15f;%0.6f\n", length, single.elapsedTime,
+            bandwidth(length, single.elapsedTime));
+    memcpy(exclusive, input, sizeof(int) * length);
+    single = measure(exclusiveScanSingleThread, exclusive, length);
+    fprintf(file, "exclusive_single;1;%d;%0.15f;%0.6f\n", length, single.elapsedTime,
+            bandwidth(length, single.elapsedTime));
+
+    const int maxThreads = omp_get_num_procs();
+    for (int numThreads = 2; numThreads < maxThreads * 2; numThreads++)
+    {
+        omp_set_num_threads(numThreads);
+        doScanMeasurement("inclusive_builtin", inclusiveScanBuiltin, input, inclusive, work, length, numThreads, file, errPath);
+        doScanMeasurement("inclusive_two_pass", inclusiveScanTwoPass, input, inclusive, work, length, numThreads, file, errPath);
+        doScanMeasurement("exclusive_two_pass", exclusiveScanTwoPass, input, exclusive, work, length, numThreads, file, errPath);
+        doScanMeasurement("inclusive_look_back", inclusiveScanDecoupledLookBack, input, inclusive, work, length, numThreads, file, errPath);
+        doScanMeasurement("exclusive_look_back", exclusiveScanDecoupledLookBack, input, exclusive, work, length, numThreads, file, errPath);
+    }
+    free(input);
+    free(inclusive);
+    free(exclusive);
+    free(work);
+}
+
+int PerformScanComparison()
+{
+    FILE *file = fopen("../python_scripts/reductions/scan.csv", "w+");
+    FILE *errPath = fopen("errPath.txt", "w+");
+    fprintf(file, "method;num_threads;length;elapsed_time;bandwidth_gb_s\n");
+
+    for (int i = 0; i < 30; i++)
+    {
+        doTestCycle(100, file, errPath);
+        doTestCycle(1000000, file, errPath);
+        doTestCycle(100000000, file, errPath);
+    }
+    fclose(errPath);
+    fclose(file);
+    return 0;
+}
+
+typedef struct ScanInput
+{
+    int *input;
+    int *work;
+    int length;
+} ScanInput;
+
+static void *setupScan(int size, const void *parameters)
+{
+    ScanInput *scan = malloc(sizeof(ScanInput));
+    scan->input = malloc(sizeof(int) * size);
+    scan->work = malloc(sizeof(int) * size);
+    scan->length = size;
+    FillWithRandomValues(size, scan->input);
+    return scan;
+}
+
+// Scans run in place, so every timed call starts from a fresh copy.
+static void resetScan(void *input)
+{
+    ScanInput *scan = input;
+    memcpy(scan->work, scan->input, sizeof(int) * scan->length);
+}
+
+static void teardownScan(void *input)
+{
+    ScanInput *scan = input;
+    free(scan->input);
+    free(scan->work);
+    free(scan);
+}
+
+static double runInclusiveSingleThread(void *input)
+{
+    ScanInput *s = input;
+    return inclusiveScanSingleThread(s->work, s->length);
+}
+
+static double runExclusiveSingleThread(void *input)
+{
+    ScanInput *s = input;
+    return exclusiveScanSingleThread(s->work, s->length);
+}
+
+static double runInclusiveBuiltin(void *input)
+{
+    ScanInput *s = input;
+    return inclusiveScanBuiltin(s->work, s->length);
+}
+
+static double runInclusiveTwoPass(void *input)
+{
+    ScanInput *s = input;
+    return inclusiveScanTwoPass(s->work, s->length);
+}
+
+static double runExclusiveTwoPass(void *input)
+{
+    ScanInput *s = input;
+    return exclusiveScanTwoPass(s->work, s->length);
+}
+
+static double runInclusiveLookBack(void *input)
+{
+    ScanInput *s = input;
+    return inclusiveScanDecoupledLookBack(s->work, s->length);
+}
+
+static double runExclusiveLookBack(void *input)
+{
+    ScanInput *s = input;
+    return exclusiveScanDecoupledLookBack(s->work, s->length);
+}
+
+// In place: every element is read and written once.
+static BenchmarkWork workScan(const void *input)
+{
+    const ScanInput *scan = input;
+    return (BenchmarkWork){.bytes = 2.0 * sizeof(int) * scan->length, .operations = scan->length};
+}
+
+void RegisterScanBenchmarks()
+{
+    const BenchmarkGroup *group = RegisterBenchmarkGroup((BenchmarkGroup){
+        .name = "scan",
+        .setup = setupScan,
+        .reset = resetScan,
+        .teardown = teardownScan,
+        .work = workScan,
+        .numDefaultSizes = 3,
+        .defaultSizes = {100, 1000000, 100000000}});
+    RegisterBenchmark(group, "inclusive_single", runInclusiveSingleThread, 0);
+    RegisterBenchmark(group, "exclusive_single", runExclusiveSingleThread, 0);
+    RegisterBenchmark(group, "inclusive_builtin", runInclusiveBuiltin, 1);
+    RegisterBenchmark(group, "inclusive_two_pass", runInclusiveTwoPass, 1);
+    RegisterBenchmark(group, "exclusive_two_pass", runExclusiveTwoPass, 1);
+    RegisterBenchmark(group, "inclusive_look_back", runInclusiveLookBack, 1);
+    RegisterBenchmark(group, "exclusive_look_back", runExclusiveLookBack, 1);
+}
@@ -0,0 +1,5 @@
+
+int PerformScanComparison();
+
+void RegisterScanBenchmarks();
+
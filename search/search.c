@@ -0,0 +1,320 @@
+#include "search.h"
+#include "omp.h"
+#include "malloc.h"
+#include "limits.h"
+#include "../utils/utils.h"
+#include "../datatypes/hugePages.h"
+#include "../benchmark/registry.h"
+
+// Elements scanned between two checks for an earlier match.
+#define SEARCH_CHUNK 4096
+
+int FindFirstSingleThread(int *vector, int size, int threshold)
+{
+    for (int i = 0; i < size; i++)
+    {
+        if (vector[i] < threshold)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int FindFirstWithFullScan(int *vector, int size, int threshold)
+{
+    int first = INT_MAX;
+    int i;
+#pragma omp parallel for shared(vector, size, threshold) private(i) reduction(min \
+                                                                            : first)
+    for (i = 0; i < size; i++)
+    {
+        if (vector[i] < threshold && i < first)
+        {
+            first = i;
+        }
+    }
+    return first == INT_MAX ? -1 : first;
+}
+
+/*
+ * Chunks are handed out in ascending order and scanned to the end without
+ * a cancellation point, so once a match cancels the loop every chunk
+ * before it has been or is being scanned completely, and the smallest
+ * recorded index is the first one.
+ */
+int FindFirstWithCancellation(int *vector, int size, int threshold)
+{
+    int first = INT_MAX;
+    int numChunks = (size + SEARCH_CHUNK - 1) / SEARCH_CHUNK;
+#pragma omp parallel shared(vector, size, threshold, first, numChunks) default(none)
+    {
+#pragma omp for schedule(dynamic, 1)
+        for (int chunk = 0; chunk < numChunks; chunk++)
+        {
+            int end = chunk * SEARCH_CHUNK + SEARCH_CHUNK < size ? chunk * SEARCH_CHUNK + SEARCH_CHUNK : size;
+            int found = -1;
+            for (int i = chunk * SEARCH_CHUNK; i < end; i++)
+            {
+                if (vector[i] < threshold)
+                {
+                    found = i;
+                    break;
+                }
+            }
+            if (found >= 0)
+            {
+#pragma omp critical
+                {
+                    first = found < first ? found : first;
+                }
+            }
+#pragma omp cancel for if (found >= 0)
+        }
+    }
+    return first == INT_MAX ? -1 : first;
+}
+
+/*
+ * Manual cancellation: the loop runs over all chunks, but a chunk that
+ * starts after the best match so far is skipped with one atomic read.
+ */
+int FindFirstWithChunks(int *vector, int size, int threshold)
+{
+    int first = INT_MAX;
+    int numChunks = (size + SEARCH_CHUNK - 1) / SEARCH_CHUNK;
+#pragma omp parallel for schedule(dynamic, 1) shared(vector, size, threshold, first, numChunks) default(none)
+    for (int chunk = 0; chunk < numChunks; chunk++)
+    {
+        int best;
+#pragma omp atomic read
+        best = first;
+        if (chunk * SEARCH_CHUNK > best)
+        {
+            continue;
+        }
+        int end = chunk * SEARCH_CHUNK + SEARCH_CHUNK < size ? chunk * SEARCH_CHUNK + SEARCH_CHUNK : size;
+        for (int i = chunk * SEARCH_CHUNK; i < end; i++)
+        {
+            if (vector[i] < threshold)
+            {
+#pragma omp critical
+                {
+                    first = i < first ? i : first;
+                }
+                break;
+            }
+        }
+    }
+    return first == INT_MAX ? -1 : first;
+}
+
+int AnyBelowSingleThread(int *vector, int size, int threshold)
+{
+    return FindFirstSingleThread(vector, size, threshold) >= 0;
+}
+
+int AnyBelowWithFullScan(int *vector, int size, int threshold)
+{
+    int any = 0;
+    int i;
+#pragma omp parallel for shared(vector, size, threshold) private(i) reduction(|| \
+                                                                            : any)
+    for (i = 0; i < size; i++)
+    {
+        any = any || vector[i] < threshold;
+    }
+    return any;
+}
+
+// Any match will do, so a thread cancels right at it and the others stop
+// at their next chunk boundary.
+int AnyBelowWithCancellation(int *vector, int size, int threshold)
+{
+    int any = 0;
+    int numChunks = (size + SEARCH_CHUNK - 1) / SEARCH_CHUNK;
+#pragma omp parallel shared(vector, size, threshold, any, numChunks) default(none)
+    {
+#pragma omp for schedule(static)
+        for (int chunk = 0; chunk < numChunks; chunk++)
+        {
+            int end = chunk * SEARCH_CHUNK + SEARCH_CHUNK < size ? chunk * SEARCH_CHUNK + SEARCH_CHUNK : size;
+            for (int i = chunk * SEARCH_CHUNK; i < end; i++)
+            {
+                if (vector[i] < threshold)
+                {
+#pragma omp atomic write
+                    any = 1;
+#pragma omp cancel for
+                    break;
+                }
+            }
+#pragma omp cancellation point for
+        }
+    }
+    return any;
+}
+
+int AnyBelowWithChunks(int *vector, int size, int threshold)
+{
+    int any = 0;
+    int numChunks = (size + SEARCH_CHUNK - 1) / SEARCH_CHUNK;
+#pragma omp parallel for schedule(static) shared(vector, size, threshold, any, numChunks) default(none)
+    for (int chunk = 0; chunk < numChunks; chunk++)
+    {
+        int found;
+#pragma omp atomic read
+        found = any;
+        if (found)
+        {
+            continue;
+        }
+        int end = chunk * SEARCH_CHUNK + SEARCH_CHUNK < size ? chunk * SEARCH_CHUNK + SEARCH_CHUNK : size;
+        for (int i = chunk * SEARCH_CHUNK; i < end; i++)
+        {
+            if (vector[i] < threshold)
+            {
+#pragma omp atomic write
+                any = 1;
+                break;
+            }
+        }
+    }
+    return any;
+}
+
+typedef struct SearchInput
+{
+    int *vector;
+    int size;
+} SearchInput;
+
+typedef struct SearchParameters
+{
+    // Position of the only element below 0 as a fraction of the size;
+    // negative for none.
+    double matchPosition;
+} SearchParameters;
+
+static void *setupSearch(int size, const void *parameters)
+{
+    const SearchParameters *search = parameters;
+    SearchInput *input = malloc(sizeof(SearchInput));
+    input->vector = AllocatePages(sizeof(int) * size);
+    input->size = size;
+    for (int i = 0; i < size; i++)
+    {
+        input->vector[i] = GetRandomInteger(0, size);
+    }
+    if (search->matchPosition >= 0)
+    {
+        input->vector[(int)(search->matchPosition * (size - 1))] = -1;
+    }
+    static int warned = 0;
+    if (!omp_get_cancellation() && !warned)
+    {
+        fprintf(stderr, "OMP_CANCELLATION is not set, the cancel variants scan everything\n");
+        warned = 1;
+    }
+    return input;
+}
+
+static void teardownSearch(void *input)
+{
+    SearchInput *search = input;
+    FreePages(search->vector);
+    free(search);
+}
+
+static double runFindFirstSingleThread(void *input)
+{
+    SearchInput *s = input;
+    return FindFirstSingleThread(s->vector, s->size, 0);
+}
+
+static double runFindFirstWithFullScan(void *input)
+{
+    SearchInput *s = input;
+    return FindFirstWithFullScan(s->vector, s->size, 0);
+}
+
+static double runFindFirstWithCancellation(void *input)
+{
+    SearchInput *s = input;
+    return FindFirstWithCancellation(s->vector, s->size, 0);
+}
+
+static double runFindFirstWithChunks(void *input)
+{
+    SearchInput *s = input;
+    return FindFirstWithChunks(s->vector, s->size, 0);
+}
+
+static double runAnyBelowSingleThread(void *input)
+{
+    SearchInput *s = input;
+    return AnyBelowSingleThread(s->vector, s->size, 0);
+}
+
+static double runAnyBelowWithFullScan(void *input)
+{
+    SearchInput *s = input;
+    return AnyBelowWithFullScan(s->vector, s->size, 0);
+}
+
+static double runAnyBelowWithCancellation(void *input)
+{
+    SearchInput *s = input;
+    return AnyBelowWithCancellation(s->vector, s->size, 0);
+}
+
+static double runAnyBelowWithChunks(void *input)
+{
+    SearchInput *s = input;
+    return AnyBelowWithChunks(s->vector, s->size, 0);
+}
+
+// The whole vector, so early exits show up as throughput above a full scan.
+static BenchmarkWork workSearch(const void *input)
+{
+    const SearchInput *search = input;
+    return (BenchmarkWork){.bytes = sizeof(int) * (double)search->size, .operations = search->size};
+}
+
+static const SearchParameters registeredPositions[] = {{0.01}, {0.5}, {0.99}, {-1}};
+static const char *registeredPositionNames[] = {"1pct", "50pct", "99pct", "none"};
+
+void RegisterSearchBenchmarks()
+{
+    static char groupNames[8][32];
+    for (int p = 0; p < 4; p++)
+    {
+        snprintf(groupNames[2 * p], sizeof(groupNames[0]), "find_first_%s", registeredPositionNames[p]);
+        const BenchmarkGroup *group = RegisterBenchmarkGroup((BenchmarkGroup){
+            .name = groupNames[2 * p],
+            .setup = setupSearch,
+            .teardown = teardownSearch,
+            .work = workSearch,
+            .parameters = &registeredPositions[p],
+            .numDefaultSizes = 3,
+            .defaultSizes = {100, 100000, 100000000}});
+        RegisterBenchmark(group, "single", runFindFirstSingleThread, 0);
+        RegisterBenchmark(group, "full_scan", runFindFirstWithFullScan, 1);
+        RegisterBenchmark(group, "cancel", runFindFirstWithCancellation, 1);
+        RegisterBenchmark(group, "chunks", runFindFirstWithChunks, 1);
+
+        snprintf(groupNames[2 * p + 1], sizeof(groupNames[0]), "any_of_%s", registeredPositionNames[p]);
+        group = RegisterBenchmarkGroup((BenchmarkGroup){
+            .name = groupNames[2 * p + 1],
+            .setup = setupSearch,
+            .teardown = teardownSearch,
+            .work = workSearch,
+            .parameters = &registeredPositions[p],
+            .numDefaultSizes = 3,
+            .defaultSizes = {100, 100000, 100000000}});
+        RegisterBenchmark(group, "single", runAnyBelowSingleThread, 0);
+        RegisterBenchmark(group, "full_scan", runAnyBelowWithFullScan, 1);
+        RegisterBenchmark(group, "cancel", runAnyBelowWithCancellation, 1);
+        RegisterBenchmark(group, "chunks", runAnyBelowWithChunks, 1);
+    }
+}
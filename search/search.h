@@ -0,0 +1,28 @@
+#ifndef OPENMP_SEARCH_H
+#define OPENMP_SEARCH_H
+#endif
+
+/*
+ * FindFirst* return the index of the first element below threshold, or -1;
+ * AnyBelow* return whether there is one. The *WithCancellation variants
+ * stop early only when the runtime has OMP_CANCELLATION=true and fall back
+ * to a full scan otherwise; the *WithChunks variants stop early anyway.
+ */
+
+int FindFirstSingleThread(int *vector, int size, int threshold);
+
+int FindFirstWithFullScan(int *vector, int size, int threshold);
+
+int FindFirstWithCancellation(int *vector, int size, int threshold);
+
+int FindFirstWithChunks(int *vector, int size, int threshold);
+
+int AnyBelowSingleThread(int *vector, int size, int threshold);
+
+int AnyBelowWithFullScan(int *vector, int size, int threshold);
+
+int AnyBelowWithCancellation(int *vector, int size, int threshold);
+
+int AnyBelowWithChunks(int *vector, int size, int threshold);
+
+void RegisterSearchBenchmarks();
@@ -0,0 +1,283 @@
+#include "sort.h"
+#include "omp.h"
+#include "malloc.h"
+#include "string.h"
+#include "../utils/utils.h"
+#include "../datatypes/hugePages.h"
+#include "../benchmark/registry.h"
+
+// Subarrays below SORT_CUTOFF are sorted with qsort, merges of fewer than
+// MERGE_CUTOFF elements are not split further.
+#define SORT_CUTOFF 4096
+#define MERGE_CUTOFF 8192
+#define RADIX_BITS 8
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+#define SIGN_FLIP 0x80000000u
+
+static int compareInts(const void *a, const void *b)
+{
+    int x = *(const int *)a;
+    int y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+static void getThreadRange(int length, int *start, int *end)
+{
+    int numThreads = omp_get_num_threads();
+    int threadNum = omp_get_thread_num();
+    int chunkSize = length / numThreads;
+    *start = threadNum * chunkSize;
+    *end = threadNum == numThreads - 1
+               ? length
+               : *start + chunkSize;
+}
+
+void SortSingleThread(int *vector, int size)
+{
+    qsort(vector, size, sizeof(int), compareInts);
+}
+
+// Number of elements of sorted values that are less than key.
+static int lowerBound(const int *values, int size, int key)
+{
+    int low = 0;
+    int high = size;
+    while (low < high)
+    {
+        int middle = low + (high - low) / 2;
+        if (values[middle] < key)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+/*
+ * Merges two sorted runs into out. Large merges are split at the middle
+ * element of the longer run and its rank in the shorter one, so both
+ * halves can be merged by independent tasks.
+ */
+static void mergeTask(const int *a, int sizeA, const int *b, int sizeB, int *out)
+{
+    if (sizeA < sizeB)
+    {
+        const int *swap = a;
+        a = b;
+        b = swap;
+        int swapSize = sizeA;
+        sizeA = sizeB;
+        sizeB = swapSize;
+    }
+    if (sizeA + sizeB <= MERGE_CUTOFF)
+    {
+        int i = 0, j = 0, k = 0;
+        while (i < sizeA && j < sizeB)
+        {
+            out[k++] = b[j] < a[i] ? b[j++] : a[i++];
+        }
+        while (i < sizeA)
+        {
+            out[k++] = a[i++];
+        }
+        while (j < sizeB)
+        {
+            out[k++] = b[j++];
+        }
+        return;
+    }
+    int middleA = sizeA / 2;
+    int middleB = lowerBound(b, sizeB, a[middleA]);
+    out[middleA + middleB] = a[middleA];
+#pragma omp task default(none) firstprivate(a, b, out, middleA, middleB)
+    mergeTask(a, middleA, b, middleB, out);
+#pragma omp task default(none) firstprivate(a, b, out, sizeA, sizeB, middleA, middleB)
+    mergeTask(a + middleA + 1, sizeA - middleA - 1, b + middleB, sizeB - middleB, out + middleA + middleB + 1);
+#pragma omp taskwait
+}
+
+/*
+ * Sorts data and leaves the result in scratch if toScratch is set, in data
+ * otherwise. The halves are sorted into the other buffer, so every level
+ * merges once without copying back.
+ */
+static void mergeSortTask(int *data, int *scratch, int size, int toScratch)
+{
+    if (size <= SORT_CUTOFF)
+    {
+        qsort(data, size, sizeof(int), compareInts);
+        if (toScratch)
+        {
+            memcpy(scratch, data, sizeof(int) * size);
+        }
+        return;
+    }
+    int half = size / 2;
+#pragma omp task default(none) firstprivate(data, scratch, half, toScratch)
+    mergeSortTask(data, scratch, half, !toScratch);
+#pragma omp task default(none) firstprivate(data, scratch, size, half, toScratch)
+    mergeSortTask(data + half, scratch + half, size - half, !toScratch);
+#pragma omp taskwait
+    const int *from = toScratch ? data : scratch;
+    int *to = toScratch ? scratch : data;
+    mergeTask(from, half, from + half, size - half, to);
+}
+
+void SortWithMergeTasks(int *vector, int size)
+{
+    int *scratch = AllocatePages(sizeof(int) * (size > 0 ? size : 1));
+#pragma omp parallel shared(vector, scratch, size) default(none)
+    {
+#pragma omp single
+        mergeSortTask(vector, scratch, size, 0);
+    }
+    FreePages(scratch);
+}
+
+/*
+ * Least significant digit first, RADIX_BITS per pass over the keys with
+ * the sign bit flipped. Every thread counts the digits of its static range;
+ * the histograms are turned into per-thread write offsets ordered by
+ * bucket, then by thread, so each thread scatters its range into the
+ * buffer without synchronisation and the pass stays stable. Passes where
+ * all keys share the digit are skipped.
+ */
+void SortWithRadix(int *vector, int size)
+{
+    int *buffer = AllocatePages(sizeof(int) * (size > 0 ? size : 1));
+    int *offsets = malloc(sizeof(int) * RADIX_BUCKETS * omp_get_max_threads());
+    int *from = vector;
+    int *to = buffer;
+    for (int shift = 0; shift < 32; shift += RADIX_BITS)
+    {
+        int skip = 0;
+#pragma omp parallel shared(from, to, size, offsets, shift, skip) default(none)
+        {
+            int numThreads = omp_get_num_threads();
+            int *offset = offsets + RADIX_BUCKETS * omp_get_thread_num();
+            int start, end;
+            getThreadRange(size, &start, &end);
+            memset(offset, 0, sizeof(int) * RADIX_BUCKETS);
+            for (int i = start; i < end; i++)
+            {
+                offset[(((unsigned int)from[i] ^ SIGN_FLIP) >> shift) & (RADIX_BUCKETS - 1)]++;
+            }
+#pragma omp barrier
+#pragma omp single
+            {
+                int running = 0;
+                for (int b = 0; b < RADIX_BUCKETS; b++)
+                {
+                    int bucketStart = running;
+                    for (int t = 0; t < numThreads; t++)
+                    {
+                        int count = offsets[RADIX_BUCKETS * t + b];
+                        offsets[RADIX_BUCKETS * t + b] = running;
+                        running += count;
+                    }
+                    skip |= running - bucketStart == size;
+                }
+            }
+            if (!skip)
+            {
+                for (int i = start; i < end; i++)
+                {
+                    to[offset[(((unsigned int)from[i] ^ SIGN_FLIP) >> shift) & (RADIX_BUCKETS - 1)]++] = from[i];
+                }
+            }
+        }
+        if (!skip)
+        {
+            int *swap = from;
+            from = to;
+            to = swap;
+        }
+    }
+    if (from != vector)
+    {
+#pragma omp parallel for shared(vector, from, size) default(none)
+        for (int i = 0; i < size; i++)
+        {
+            vector[i] = from[i];
+        }
+    }
+    free(offsets);
+    FreePages(buffer);
+}
+
+typedef struct SortInput
+{
+    Matrix *unsorted;
+    int *work;
+} SortInput;
+
+static void *setupSort(int size, const void *parameters)
+{
+    SortInput *sort = malloc(sizeof(SortInput));
+    sort->unsorted = InitializeArrays(size);
+    sort->work = AllocatePages(sizeof(int) * size);
+    return sort;
+}
+
+// Sorts run in place, so every timed call starts from the unsorted input.
+static void resetSort(void *input)
+{
+    SortInput *sort = input;
+    memcpy(sort->work, sort->unsorted->data, sizeof(int) * sort->unsorted->nCols);
+}
+
+static void teardownSort(void *input)
+{
+    SortInput *sort = input;
+    FreeMatrix(sort->unsorted);
+    free(sort->unsorted);
+    FreePages(sort->work);
+    free(sort);
+}
+
+static double runSortSingleThread(void *input)
+{
+    SortInput *s = input;
+    SortSingleThread(s->work, s->unsorted->nCols);
+    return s->work[s->unsorted->nCols / 2];
+}
+
+static double runSortWithMergeTasks(void *input)
+{
+    SortInput *s = input;
+    SortWithMergeTasks(s->work, s->unsorted->nCols);
+    return s->work[s->unsorted->nCols / 2];
+}
+
+static double runSortWithRadix(void *input)
+{
+    SortInput *s = input;
+    SortWithRadix(s->work, s->unsorted->nCols);
+    return s->work[s->unsorted->nCols / 2];
+}
+
+// In place: every element is read and written once.
+static BenchmarkWork workSort(const void *input)
+{
+    const SortInput *sort = input;
+    return (BenchmarkWork){.bytes = 2.0 * sizeof(int) * sort->unsorted->nCols, .operations = sort->unsorted->nCols};
+}
+
+void RegisterSortBenchmarks()
+{
+    const BenchmarkGroup *group = RegisterBenchmarkGroup((BenchmarkGroup){
+        .name = "sort",
+        .setup = setupSort,
+        .reset = resetSort,
+        .teardown = teardownSort,
+        .work = workSort,
+        .numDefaultSizes = 3,
+        .defaultSizes = {100, 100000, 100000000}});
+    RegisterBenchmark(group, "single", runSortSingleThread, 0);
+    RegisterBenchmark(group, "merge_tasks", runSortWithMergeTasks, 1);
+    RegisterBenchmark(group, "radix", runSortWithRadix, 1);
+}
@@ -0,0 +1,13 @@
+#ifndef OPENMP_SORT_H
+#define OPENMP_SORT_H
+#endif
+
+// All variants sort vector ascending in place.
+
+void SortSingleThread(int *vector, int size);
+
+void SortWithMergeTasks(int *vector, int size);
+
+void SortWithRadix(int *vector, int size);
+
+void RegisterSortBenchmarks();
@@ -0,0 +1,476 @@
+#include "./spmv.h"
+#include "limits.h"
+#include "omp.h"
+#include "malloc.h"
+#include "stdlib.h"
+#include "../utils/utils.h"
+#include "../datatypes/sparseMatrix.h"
+#include "../datatypes/hugePages.h"
+#include "../benchmark/registry.h"
+#include "../benchmark/loadBalance.h"
+
+#define MEAN_ROW_LENGTH 16
+#define POWER_LAW_ALPHA 1.5
+#define SELL_CHUNK_HEIGHT 8
+#define SELL_SORT_WINDOW 256
+#define MATRIX_FILE_VARIABLE "OPENMP_SPARSE_MATRIX"
+
+/*
+ * y = A x and the dense-equivalent row minimax (the largest row minimum,
+ * where a row with fewer entries than columns also contains zeros) over a
+ * CSR matrix. Rows are the unit of work, so on power-law inputs a static
+ * split by rows is as unbalanced as the row lengths; the nnz-balanced
+ * variants cut the rows into per-thread ranges of equal entry counts.
+ */
+
+static long long spmvRow(const SparseMatrix *matrix, const int *x, int row)
+{
+    long long sum = 0;
+    for (int k = matrix->rowStarts[row]; k < matrix->rowStarts[row + 1]; k++)
+    {
+        sum += (long long)matrix->values[k] * x[matrix->colIndices[k]];
+    }
+    return sum;
+}
+
+static int rowMinimum(const SparseMatrix *matrix, int row)
+{
+    int rowMin = matrix->rowStarts[row + 1] - matrix->rowStarts[row] < matrix->nCols ? 0 : INT_MAX;
+    for (int k = matrix->rowStarts[row]; k < matrix->rowStarts[row + 1]; k++)
+    {
+        if (matrix->values[k] < rowMin)
+        {
+            rowMin = matrix->values[k];
+        }
+    }
+    return rowMin;
+}
+
+// First row whose entries start at or after entry.
+static int findRowByEntry(const SparseMatrix *matrix, long long entry)
+{
+    int low = 0;
+    int high = matrix->nRows;
+    while (low < high)
+    {
+        int middle = low + (high - low) / 2;
+        if (matrix->rowStarts[middle] < entry)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+static void getBalancedRows(const SparseMatrix *matrix, int *start, int *end)
+{
+    long long numEntries = GetSparseNonZeros(matrix);
+    int numThreads = omp_get_num_threads();
+    int threadNum = omp_get_thread_num();
+    *start = findRowByEntry(matrix, numEntries * threadNum / numThreads);
+    *end = threadNum == numThreads - 1 ? matrix->nRows : findRowByEntry(matrix, numEntries * (threadNum + 1) / numThreads);
+}
+
+static void spmvSingleThread(const SparseMatrix *matrix, const int *x, long long *y)
+{
+    for (int i = 0; i < matrix->nRows; i++)
+    {
+        y[i] = spmvRow(matrix, x, i);
+    }
+}
+
+static void spmvStatic(const SparseMatrix *matrix, const int *x, long long *y)
+{
+#pragma omp parallel shared(matrix, x, y) default(none)
+    {
+        LOAD_BALANCE_THREAD_BEGIN();
+#pragma omp for schedule(static) nowait
+        for (int i = 0; i < matrix->nRows; i++)
+        {
+            LOAD_BALANCE_ITERATION();
+            y[i] = spmvRow(matrix, x, i);
+        }
+        LOAD_BALANCE_THREAD_END();
+    }
+}
+
+static void spmvRuntimeScheduled(const SparseMatrix *matrix, const int *x, long long *y)
+{
+#pragma omp parallel shared(matrix, x, y) default(none)
+    {
+        LOAD_BALANCE_THREAD_BEGIN();
+#pragma omp for schedule(runtime) nowait
+        for (int i = 0; i < matrix->nRows; i++)
+        {
+            LOAD_BALANCE_ITERATION();
+            y[i] = spmvRow(matrix, x, i);
+        }
+        LOAD_BALANCE_THREAD_END();
+    }
+}
+
+static void spmvNnzBalanced(const SparseMatrix *matrix, const int *x, long long *y)
+{
+#pragma omp parallel shared(matrix, x, y) default(none)
+    {
+        int start, end;
+        getBalancedRows(matrix, &start, &end);
+        LOAD_BALANCE_THREAD_BEGIN();
+        for (int i = start; i < end; i++)
+        {
+            LOAD_BALANCE_ITERATION();
+            y[i] = spmvRow(matrix, x, i);
+        }
+        LOAD_BALANCE_THREAD_END();
+    }
+}
+
+/*
+ * A chunk's rows are updated together, one padded column at a time, so
+ * the inner loop runs over chunkHeight contiguous entries. Chunks still
+ * differ in width across sort windows and are handed out dynamically.
+ */
+static void spmvSell(const SellMatrix *matrix, const int *x, long long *y)
+{
+#pragma omp parallel shared(matrix, x, y) default(none)
+    {
+        long long sums[SELL_CHUNK_HEIGHT];
+        LOAD_BALANCE_THREAD_BEGIN();
+#pragma omp for schedule(dynamic, 16) nowait
+        for (int c = 0; c < matrix->numChunks; c++)
+        {
+            LOAD_BALANCE_ITERATION();
+            const int *columns = matrix->colIndices + matrix->chunkStarts[c];
+            const int *values = matrix->values + matrix->chunkStarts[c];
+            for (int i = 0; i < SELL_CHUNK_HEIGHT; i++)
+            {
+                sums[i] = 0;
+            }
+            for (int j = 0; j < matrix->chunkWidths[c]; j++)
+            {
+                for (int i = 0; i < SELL_CHUNK_HEIGHT; i++)
+                {
+                    sums[i] += (long long)values[i] * x[columns[i]];
+                }
+                columns += SELL_CHUNK_HEIGHT;
+                values += SELL_CHUNK_HEIGHT;
+            }
+            for (int i = 0; i < SELL_CHUNK_HEIGHT; i++)
+            {
+                int row = matrix->rowOrder[c * SELL_CHUNK_HEIGHT + i];
+                if (row >= 0)
+                {
+                    y[row] = sums[i];
+                }
+            }
+        }
+        LOAD_BALANCE_THREAD_END();
+    }
+}
+
+static int minimaxSingleThread(const SparseMatrix *matrix)
+{
+    int maxVal = INT_MIN;
+    for (int i = 0; i < matrix->nRows; i++)
+    {
+        int rowMin = rowMinimum(matrix, i);
+        if (rowMin > maxVal)
+        {
+            maxVal = rowMin;
+        }
+    }
+    return maxVal;
+}
+
+static int minimaxStatic(const SparseMatrix *matrix)
+{
+    int maxVal = INT_MIN;
+#pragma omp parallel shared(matrix) reduction(max \
+                                              : maxVal)
+    {
+        LOAD_BALANCE_THREAD_BEGIN();
+#pragma omp for schedule(static) nowait
+        for (int i = 0; i < matrix->nRows; i++)
+        {
+            LOAD_BALANCE_ITERATION();
+            int rowMin = rowMinimum(matrix, i);
+            if (rowMin > maxVal)
+            {
+                maxVal = rowMin;
+            }
+        }
+        LOAD_BALANCE_THREAD_END();
+    }
+    return maxVal;
+}
+
+static int minimaxRuntimeScheduled(const SparseMatrix *matrix)
+{
+    int maxVal = INT_MIN;
+#pragma omp parallel shared(matrix) reduction(max \
+                                              : maxVal)
+    {
+        LOAD_BALANCE_THREAD_BEGIN();
+#pragma omp for schedule(runtime) nowait
+        for (int i = 0; i < matrix->nRows; i++)
+        {
+            LOAD_BALANCE_ITERATION();
+            int rowMin = rowMinimum(matrix, i);
+            if (rowMin > maxVal)
+            {
+                maxVal = rowMin;
+            }
+        }
+        LOAD_BALANCE_THREAD_END();
+    }
+    return maxVal;
+}
+
+static int minimaxNnzBalanced(const SparseMatrix *matrix)
+{
+    int maxVal = INT_MIN;
+#pragma omp parallel shared(matrix) reduction(max \
+                                              : maxVal)
+    {
+        int start, end;
+        getBalancedRows(matrix, &start, &end);
+        LOAD_BALANCE_THREAD_BEGIN();
+        for (int i = start; i < end; i++)
+        {
+            LOAD_BALANCE_ITERATION();
+            int rowMin = rowMinimum(matrix, i);
+            if (rowMin > maxVal)
+            {
+                maxVal = rowMin;
+            }
+        }
+        LOAD_BALANCE_THREAD_END();
+    }
+    return maxVal;
+}
+
+typedef enum SparseSource
+{
+    SPARSE_UNIFORM,
+    SPARSE_POWER_LAW,
+    SPARSE_FILE
+} SparseSource;
+
+typedef struct SpmvParameters
+{
+    SparseSource source;
+    // The SELL-C-sigma copy is only built for the SpMV groups.
+    int withSell;
+} SpmvParameters;
+
+typedef struct SpmvInput
+{
+    SparseMatrix *matrix;
+    SellMatrix *sell;
+    int *x;
+    long long *y;
+} SpmvInput;
+
+/*
+ * size is the number of rows: generated matrices are size x size, a matrix
+ * from OPENMP_SPARSE_MATRIX is cut to its first size rows.
+ */
+static void *setupSpmv(int size, const void *parameters)
+{
+    const SpmvParameters *spmv = parameters;
+    SpmvInput *input = malloc(sizeof(SpmvInput));
+    switch (spmv->source)
+    {
+    case SPARSE_FILE:
+        input->matrix = ReadSparseCoordinates(getenv(MATRIX_FILE_VARIABLE));
+        if (input->matrix == NULL)
+        {
+            exit(1);
+        }
+        if (size < input->matrix->nRows)
+        {
+            input->matrix->nRows = size;
+        }
+        break;
+    case SPARSE_POWER_LAW:
+        input->matrix = InitPowerLawSparse(size, size, MEAN_ROW_LENGTH, POWER_LAW_ALPHA);
+        break;
+    default:
+        input->matrix = InitPowerLawSparse(size, size, MEAN_ROW_LENGTH, 0);
+        break;
+    }
+    input->sell = spmv->withSell ? SellFromSparse(input->matrix, SELL_CHUNK_HEIGHT, SELL_SORT_WINDOW) : NULL;
+    input->x = AllocatePages(sizeof(int) * input->matrix->nCols);
+    input->y = AllocatePages(sizeof(long long) * input->matrix->nRows);
+    for (int j = 0; j < input->matrix->nCols; j++)
+    {
+        input->x[j] = GetRandomInteger(-1000, 1000);
+    }
+    return input;
+}
+
+static void teardownSpmv(void *input)
+{
+    SpmvInput *s = input;
+    FreeSparseMatrix(s->matrix);
+    if (s->sell != NULL)
+    {
+        FreeSellMatrix(s->sell);
+    }
+    FreePages(s->x);
+    FreePages(s->y);
+    free(s);
+}
+
+static double runSpmv(void (*method)(const SparseMatrix *, const int *, long long *), SpmvInput *s)
+{
+    method(s->matrix, s->x, s->y);
+    return s->y[0] + s->y[s->matrix->nRows - 1];
+}
+
+static double runSpmvSingleThread(void *input)
+{
+    return runSpmv(spmvSingleThread, input);
+}
+
+static double runSpmvStatic(void *input)
+{
+    return runSpmv(spmvStatic, input);
+}
+
+static double runSpmvScheduled(void *input, omp_sched_t kind, int chunkSize)
+{
+    omp_set_schedule(kind, chunkSize);
+    return runSpmv(spmvRuntimeScheduled, input);
+}
+
+static double runSpmvDynamic64(void *input)
+{
+    return runSpmvScheduled(input, omp_sched_dynamic, 64);
+}
+
+static double runSpmvGuided(void *input)
+{
+    return runSpmvScheduled(input, omp_sched_guided, 1);
+}
+
+static double runSpmvNnzBalanced(void *input)
+{
+    return runSpmv(spmvNnzBalanced, input);
+}
+
+static double runSpmvSell(void *input)
+{
+    SpmvInput *s = input;
+    spmvSell(s->sell, s->x, s->y);
+    return s->y[0] + s->y[s->matrix->nRows - 1];
+}
+
+static double runMinimaxSingleThread(void *input)
+{
+    return minimaxSingleThread(((SpmvInput *)input)->matrix);
+}
+
+static double runMinimaxStatic(void *input)
+{
+    return minimaxStatic(((SpmvInput *)input)->matrix);
+}
+
+static double runMinimaxScheduled(void *input, omp_sched_t kind, int chunkSize)
+{
+    omp_set_schedule(kind, chunkSize);
+    return minimaxRuntimeScheduled(((SpmvInput *)input)->matrix);
+}
+
+static double runMinimaxDynamic64(void *input)
+{
+    return runMinimaxScheduled(input, omp_sched_dynamic, 64);
+}
+
+static double runMinimaxGuided(void *input)
+{
+    return runMinimaxScheduled(input, omp_sched_guided, 1);
+}
+
+static double runMinimaxNnzBalanced(void *input)
+{
+    return minimaxNnzBalanced(((SpmvInput *)input)->matrix);
+}
+
+// Every entry reads its value, its column and the gathered x element once;
+// every row its start and its result.
+static BenchmarkWork workSpmv(const void *input)
+{
+    const SpmvInput *s = input;
+    double numEntries = GetSparseNonZeros(s->matrix);
+    return (BenchmarkWork){.bytes = numEntries * 3 * sizeof(int) + s->matrix->nRows * (sizeof(int) + sizeof(long long)),
+                           .operations = 2 * numEntries};
+}
+
+static BenchmarkWork workMinimax(const void *input)
+{
+    const SpmvInput *s = input;
+    double numEntries = GetSparseNonZeros(s->matrix);
+    return (BenchmarkWork){.bytes = numEntries * sizeof(int) + s->matrix->nRows * sizeof(int),
+                           .operations = numEntries};
+}
+
+static const SpmvParameters registeredSpmvParameters[] = {
+    {SPARSE_UNIFORM, 1}, {SPARSE_POWER_LAW, 1}, {SPARSE_FILE, 1}};
+static const SpmvParameters registeredMinimaxParameters[] = {
+    {SPARSE_UNIFORM, 0}, {SPARSE_POWER_LAW, 0}, {SPARSE_FILE, 0}};
+static const char *registeredSpmvNames[] = {"spmv_uniform", "spmv_powerlaw", "spmv_file"};
+static const char *registeredMinimaxNames[] = {"sparse_minimax_uniform", "sparse_minimax_powerlaw",
+                                               "sparse_minimax_file"};
+
+/*
+ * The file groups are only registered when OPENMP_SPARSE_MATRIX names a
+ * Matrix Market coordinate file; their default size is all of its rows.
+ */
+void RegisterSpmvBenchmarks()
+{
+    const char *path = getenv(MATRIX_FILE_VARIABLE);
+    for (int s = 0; s < 3; s++)
+    {
+        BenchmarkGroup group = {
+            .setup = setupSpmv,
+            .teardown = teardownSpmv,
+            .numDefaultSizes = 2,
+            .defaultSizes = {100000, 1000000}};
+        if (registeredSpmvParameters[s].source == SPARSE_FILE)
+        {
+            int nRows, nCols;
+            if (path == NULL || ReadSparseCoordinatesSize(path, &nRows, &nCols) != 0)
+            {
+                continue;
+            }
+            group.numDefaultSizes = 1;
+            group.defaultSizes[0] = nRows;
+        }
+
+        group.name = registeredSpmvNames[s];
+        group.work = workSpmv;
+        group.parameters = &registeredSpmvParameters[s];
+        const BenchmarkGroup *registered = RegisterBenchmarkGroup(group);
+        RegisterBenchmark(registered, "single", runSpmvSingleThread, 0);
+        RegisterBenchmark(registered, "static", runSpmvStatic, 1);
+        RegisterBenchmark(registered, "dynamic_64", runSpmvDynamic64, 1);
+        RegisterBenchmark(registered, "guided", runSpmvGuided, 1);
+        RegisterBenchmark(registered, "nnz_balanced", runSpmvNnzBalanced, 1);
+        RegisterBenchmark(registered, "sell", runSpmvSell, 1);
+
+        group.name = registeredMinimaxNames[s];
+        group.work = workMinimax;
+        group.parameters = &registeredMinimaxParameters[s];
+        registered = RegisterBenchmarkGroup(group);
+        RegisterBenchmark(registered, "single", runMinimaxSingleThread, 0);
+        RegisterBenchmark(registered, "static", runMinimaxStatic, 1);
+        RegisterBenchmark(registered, "dynamic_64", runMinimaxDynamic64, 1);
+        RegisterBenchmark(registered, "guided", runMinimaxGuided, 1);
+        RegisterBenchmark(registered, "nnz_balanced", runMinimaxNnzBalanced, 1);
+    }
+}
@@ -0,0 +1,5 @@
+#ifndef OPENMP_SPMV_H
+#define OPENMP_SPMV_H
+#endif
+
+void RegisterSpmvBenchmarks();
@@ -13,4 +13,6 @@ int FindMinWithForLoopParallelism(int *vector, int size);
 
 int FindMinWithReduction(int *vector, int size);
 
-int PerformFindMinComparison();
\ No newline at end of file
+int PerformFindMinComparison();
+
+void RegisterFindMinBenchmarks();
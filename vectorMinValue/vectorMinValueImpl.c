@@ -4,6 +4,7 @@
 #include <stdlib.h>
 #include <time.h>
 #include "../utils/utils.h"
+#include "../benchmark/registry.h"
 #include "omp.h"
 
 int FindMinSingleThread(int *vector, int size)
@@ -94,4 +95,53 @@ int PerformFindMinComparison()
 
     fclose(f);
     return 0;
-}
\ No newline at end of file
+}
+
+static void *setupFindMin(int size, const void *parameters)
+{
+    return InitializeArrays(size);
+}
+
+static void teardownFindMin(void *input)
+{
+    FreeMatrix(input);
+    free(input);
+}
+
+static double runFindMinSingleThread(void *input)
+{
+    Matrix *matrix = input;
+    return FindMinSingleThread(matrix->data, matrix->nCols);
+}
+
+static double runFindMinWithForLoopParallelism(void *input)
+{
+    Matrix *matrix = input;
+    return FindMinWithForLoopParallelism(matrix->data, matrix->nCols);
+}
+
+static double runFindMinWithReduction(void *input)
+{
+    Matrix *matrix = input;
+    return FindMinWithReduction(matrix->data, matrix->nCols);
+}
+
+static BenchmarkWork workFindMin(const void *input)
+{
+    const Matrix *matrix = input;
+    return (BenchmarkWork){.bytes = sizeof(int) * (double)matrix->nCols, .operations = matrix->nCols};
+}
+
+void RegisterFindMinBenchmarks()
+{
+    const BenchmarkGroup *group = RegisterBenchmarkGroup((BenchmarkGroup){
+        .name = "vectorMinValue",
+        .setup = setupFindMin,
+        .teardown = teardownFindMin,
+        .work = workFindMin,
+        .numDefaultSizes = 3,
+        .defaultSizes = {100, 100000, 100000000}});
+    RegisterBenchmark(group, "single", runFindMinSingleThread, 0);
+    RegisterBenchmark(group, "critical_section", runFindMinWithForLoopParallelism, 1);
+    RegisterBenchmark(group, "reduction", runFindMinWithReduction, 1);
+}
@@ -0,0 +1,475 @@
+#include "vectorSelect.h"
+#include "omp.h"
+#include "malloc.h"
+#include "string.h"
+#include "../utils/utils.h"
+#include "../benchmark/registry.h"
+
+#define SAMPLE_SIZE 4096
+// Rank distance of the two sample pivots from the expected rank of k.
+#define PIVOT_SPREAD 128
+#define SERIAL_CUTOFF 65536
+#define RADIX_BITS 8
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+#define SIGN_FLIP 0x80000000u
+
+static int compareInts(const void *a, const void *b)
+{
+    int x = *(const int *)a;
+    int y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+static int compareIntsDescending(const void *a, const void *b)
+{
+    return compareInts(b, a);
+}
+
+static void getThreadRange(int length, int *start, int *end)
+{
+    int numThreads = omp_get_num_threads();
+    int threadNum = omp_get_thread_num();
+    int chunkSize = length / numThreads;
+    *start = threadNum * chunkSize;
+    *end = threadNum == numThreads - 1
+               ? length
+               : *start + chunkSize;
+}
+
+int SelectKthWithSort(int *vector, int size, int k)
+{
+    int *sorted = malloc(sizeof(int) * size);
+    memcpy(sorted, vector, sizeof(int) * size);
+    qsort(sorted, size, sizeof(int), compareInts);
+    int result = sorted[k];
+    free(sorted);
+    return result;
+}
+
+/*
+ * In-place quickselect with a median-of-three pivot and a three-way
+ * partition, so runs of equal keys cannot make it quadratic.
+ */
+static int quickselect(int *values, int size, int k)
+{
+    int low = 0;
+    int high = size - 1;
+    while (low < high)
+    {
+        int middle = low + (high - low) / 2;
+        int a = values[low], b = values[middle], c = values[high];
+        int pivot = a < b ? (b < c ? b : (a < c ? c : a)) : (a < c ? a : (b < c ? c : b));
+        int less = low, i = low, greater = high;
+        while (i <= greater)
+        {
+            if (values[i] < pivot)
+            {
+                int swap = values[i];
+                values[i++] = values[less];
+                values[less++] = swap;
+            }
+            else if (values[i] > pivot)
+            {
+                int swap = values[i];
+                values[i] = values[greater];
+                values[greater--] = swap;
+            }
+            else
+            {
+                i++;
+            }
+        }
+        if (k < less)
+        {
+            high = less - 1;
+        }
+        else if (k > greater)
+        {
+            low = greater + 1;
+        }
+        else
+        {
+            return pivot;
+        }
+    }
+    return values[k];
+}
+
+int SelectKthSingleThread(int *vector, int size, int k)
+{
+    int *copy = malloc(sizeof(int) * size);
+    memcpy(copy, vector, sizeof(int) * size);
+    int result = quickselect(copy, size, k);
+    free(copy);
+    return result;
+}
+
+static unsigned int nextRandom(unsigned int *state)
+{
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+/*
+ * Sample-based selection: two pivots are taken from a sorted random sample
+ * a little below and above the sample rank of k, so k falls between them
+ * with high probability and the elements in between are a small fraction
+ * of the input. One parallel pass counts the three buckets per thread, a
+ * second one copies the bucket that holds k into a buffer at per-thread
+ * offsets, and the loop continues on the buffer until it is small enough
+ * for a serial quickselect.
+ */
+int SelectKthWithSampling(int *vector, int size, int k)
+{
+    int *buffers[2] = {malloc(sizeof(int) * size), malloc(sizeof(int) * size)};
+    int *counts = malloc(sizeof(int) * 3 * omp_get_max_threads());
+    int sample[SAMPLE_SIZE];
+    unsigned int state = 0x9E3779B9u;
+    const int *current = vector;
+    int count = size;
+    int next = 0;
+    while (count > SERIAL_CUTOFF)
+    {
+        for (int s = 0; s < SAMPLE_SIZE; s++)
+        {
+            sample[s] = current[nextRandom(&state) % (unsigned int)count];
+        }
+        qsort(sample, SAMPLE_SIZE, sizeof(int), compareInts);
+        int rank = (int)((long long)k * SAMPLE_SIZE / count);
+        int lowPivot = sample[rank - PIVOT_SPREAD > 0 ? rank - PIVOT_SPREAD : 0];
+        int highPivot = sample[rank + PIVOT_SPREAD < SAMPLE_SIZE ? rank + PIVOT_SPREAD : SAMPLE_SIZE - 1];
+
+        int below = 0, between = 0;
+        int bucket;
+        int *target = buffers[next];
+#pragma omp parallel shared(current, count, lowPivot, highPivot, counts, below, between, bucket, k, target) default(none)
+        {
+            int numThreads = omp_get_num_threads();
+            int threadNum = omp_get_thread_num();
+            int start, end;
+            getThreadRange(count, &start, &end);
+            int threadCounts[3] = {0, 0, 0};
+            for (int i = start; i < end; i++)
+            {
+                threadCounts[(current[i] >= lowPivot) + (current[i] > highPivot)]++;
+            }
+            memcpy(counts + 3 * threadNum, threadCounts, sizeof(threadCounts));
+#pragma omp barrier
+#pragma omp single
+            {
+                for (int t = 0; t < numThreads; t++)
+                {
+                    below += counts[3 * t];
+                    between += counts[3 * t + 1];
+                }
+                bucket = k < below ? 0 : k < below + between ? 1 : 2;
+            }
+            int offset = 0;
+            for (int t = 0; t < threadNum; t++)
+            {
+                offset += counts[3 * t + bucket];
+            }
+            for (int i = start; i < end; i++)
+            {
+                if ((current[i] >= lowPivot) + (current[i] > highPivot) == bucket)
+                {
+                    target[offset++] = current[i];
+                }
+            }
+        }
+
+        int bucketSize = bucket == 0 ? below : bucket == 1 ? between : count - below - between;
+        if (bucket == 1 && lowPivot == highPivot)
+        {
+            count = 0;
+            current = NULL;
+            k = lowPivot;
+            break;
+        }
+        if (bucket > 0)
+        {
+            k -= below;
+        }
+        if (bucket > 1)
+        {
+            k -= between;
+        }
+        current = target;
+        next = 1 - next;
+        if (bucketSize == count)
+        {
+            // Too few distinct keys for the sample to split them.
+            break;
+        }
+        count = bucketSize;
+    }
+
+    int result;
+    if (current == NULL)
+    {
+        result = k;
+    }
+    else
+    {
+        if (current == vector)
+        {
+            memcpy(buffers[next], vector, sizeof(int) * count);
+            current = buffers[next];
+        }
+        result = quickselect((int *)current, count, k);
+    }
+    free(buffers[0]);
+    free(buffers[1]);
+    free(counts);
+    return result;
+}
+
+/*
+ * Most significant digit first radix select over the keys with the sign
+ * bit flipped, RADIX_BITS at a time: each pass builds per-thread
+ * histograms of the keys that share the digits fixed so far, merges them
+ * and fixes the digit of the bucket holding k. The input is only read.
+ */
+int SelectKthWithRadix(int *vector, int size, int k)
+{
+    int *histograms = malloc(sizeof(int) * RADIX_BUCKETS * omp_get_max_threads());
+    int counts[RADIX_BUCKETS];
+    unsigned int prefix = 0;
+    unsigned int mask = 0;
+    for (int shift = 32 - RADIX_BITS; shift >= 0; shift -= RADIX_BITS)
+    {
+#pragma omp parallel shared(vector, size, histograms, counts, prefix, mask, shift) default(none)
+        {
+            int numThreads = omp_get_num_threads();
+            int *histogram = histograms + RADIX_BUCKETS * omp_get_thread_num();
+            int start, end;
+            getThreadRange(size, &start, &end);
+            memset(histogram, 0, sizeof(int) * RADIX_BUCKETS);
+            for (int i = start; i < end; i++)
+            {
+                unsigned int key = (unsigned int)vector[i] ^ SIGN_FLIP;
+                if ((key & mask) == prefix)
+                {
+                    histogram[(key >> shift) & (RADIX_BUCKETS - 1)]++;
+                }
+            }
+#pragma omp barrier
+#pragma omp for
+            for (int b = 0; b < RADIX_BUCKETS; b++)
+            {
+                int count = 0;
+                for (int t = 0; t < numThreads; t++)
+                {
+                    count += histograms[RADIX_BUCKETS * t + b];
+                }
+                counts[b] = count;
+            }
+        }
+        int b = 0;
+        while (k >= counts[b])
+        {
+            k -= counts[b++];
+        }
+        prefix |= (unsigned int)b << shift;
+        mask |= (unsigned int)(RADIX_BUCKETS - 1) << shift;
+    }
+    free(histograms);
+    return (int)(prefix ^ SIGN_FLIP);
+}
+
+void FindTopKWithSort(int *vector, int size, int k, int *top)
+{
+    int *sorted = malloc(sizeof(int) * size);
+    memcpy(sorted, vector, sizeof(int) * size);
+    qsort(sorted, size, sizeof(int), compareIntsDescending);
+    memcpy(top, sorted, sizeof(int) * k);
+    free(sorted);
+}
+
+static void siftDown(int *heap, int size, int position)
+{
+    int value = heap[position];
+    for (;;)
+    {
+        int child = 2 * position + 1;
+        if (child >= size)
+        {
+            break;
+        }
+        if (child + 1 < size && heap[child + 1] < heap[child])
+        {
+            child++;
+        }
+        if (heap[child] >= value)
+        {
+            break;
+        }
+        heap[position] = heap[child];
+        position = child;
+    }
+    heap[position] = value;
+}
+
+// Keeps the k largest of values in a min-heap; returns its size.
+static int collectLargest(const int *values, int count, int k, int *heap)
+{
+    int size = count < k ? count : k;
+    memcpy(heap, values, sizeof(int) * size);
+    for (int i = size / 2 - 1; i >= 0; i--)
+    {
+        siftDown(heap, size, i);
+    }
+    for (int i = size; i < count; i++)
+    {
+        if (values[i] > heap[0])
+        {
+            heap[0] = values[i];
+            siftDown(heap, size, 0);
+        }
+    }
+    return size;
+}
+
+/*
+ * Every thread keeps the k largest elements of its range in a private
+ * min-heap, so most elements cost a single comparison with the root. The
+ * numThreads * k survivors are merged with one more heap pass.
+ */
+void FindTopKWithHeaps(int *vector, int size, int k, int *top)
+{
+    int maxThreads = omp_get_max_threads();
+    int *candidates = malloc(sizeof(int) * (size_t)k * maxThreads);
+    int numCandidates = 0;
+#pragma omp parallel shared(vector, size, k, candidates, numCandidates) default(none)
+    {
+        int *heap = malloc(sizeof(int) * k);
+        int start, end;
+        getThreadRange(size, &start, &end);
+        int heapSize = collectLargest(vector + start, end - start, k, heap);
+        int offset;
+#pragma omp atomic capture
+        {
+            offset = numCandidates;
+            numCandidates += heapSize;
+        }
+        memcpy(candidates + offset, heap, sizeof(int) * heapSize);
+        free(heap);
+    }
+    int heapSize = collectLargest(candidates, numCandidates, k, top);
+    qsort(top, heapSize, sizeof(int), compareIntsDescending);
+    free(candidates);
+}
+
+typedef struct SelectInput
+{
+    Matrix *array;
+    int k;
+    int *top;
+} SelectInput;
+
+typedef struct SelectParameters
+{
+    // Rank of the selected element as a fraction of size - 1; ignored when
+    // topK is set.
+    double quantile;
+    int topK;
+} SelectParameters;
+
+static void *setupSelect(int size, const void *parameters)
+{
+    const SelectParameters *select = parameters;
+    SelectInput *input = malloc(sizeof(SelectInput));
+    input->array = InitializeArrays(size);
+    input->k = select->topK > 0
+                   ? (select->topK < size ? select->topK : size)
+                   : (int)(select->quantile * (size - 1));
+    input->top = malloc(sizeof(int) * (input->k > 0 ? input->k : 1));
+    return input;
+}
+
+static void teardownSelect(void *input)
+{
+    SelectInput *s = input;
+    FreeMatrix(s->array);
+    free(s->array);
+    free(s->top);
+    free(s);
+}
+
+static double runSelectWithSort(void *input)
+{
+    SelectInput *s = input;
+    return SelectKthWithSort(s->array->data, s->array->nCols, s->k);
+}
+
+static double runSelectSingleThread(void *input)
+{
+    SelectInput *s = input;
+    return SelectKthSingleThread(s->array->data, s->array->nCols, s->k);
+}
+
+static double runSelectWithSampling(void *input)
+{
+    SelectInput *s = input;
+    return SelectKthWithSampling(s->array->data, s->array->nCols, s->k);
+}
+
+static double runSelectWithRadix(void *input)
+{
+    SelectInput *s = input;
+    return SelectKthWithRadix(s->array->data, s->array->nCols, s->k);
+}
+
+static double runTopKWithSort(void *input)
+{
+    SelectInput *s = input;
+    FindTopKWithSort(s->array->data, s->array->nCols, s->k, s->top);
+    return s->top[s->k - 1];
+}
+
+static double runTopKWithHeaps(void *input)
+{
+    SelectInput *s = input;
+    FindTopKWithHeaps(s->array->data, s->array->nCols, s->k, s->top);
+    return s->top[s->k - 1];
+}
+
+// One read of the input and a comparison per element, as for the minimum;
+// extra passes and the sort's n log n are what the variants differ in.
+static BenchmarkWork workSelect(const void *input)
+{
+    const SelectInput *s = input;
+    return (BenchmarkWork){.bytes = sizeof(int) * (double)s->array->nCols, .operations = s->array->nCols};
+}
+
+static const SelectParameters registeredSelections[] = {{0.5, 0}, {0.99, 0}, {0, 100}};
+static const char *registeredGroupNames[] = {"vectorSelect_median", "vectorSelect_p99", "vectorTopK_100"};
+
+void RegisterSelectBenchmarks()
+{
+    for (int s = 0; s < 3; s++)
+    {
+        const BenchmarkGroup *group = RegisterBenchmarkGroup((BenchmarkGroup){
+            .name = registeredGroupNames[s],
+            .setup = setupSelect,
+            .teardown = teardownSelect,
+            .work = workSelect,
+            .parameters = &registeredSelections[s],
+            .numDefaultSizes = 3,
+            .defaultSizes = {100, 100000, 10000000}});
+        if (registeredSelections[s].topK > 0)
+        {
+            RegisterBenchmark(group, "sort", runTopKWithSort, 0);
+            RegisterBenchmark(group, "heaps", runTopKWithHeaps, 1);
+            continue;
+        }
+        RegisterBenchmark(group, "sort", runSelectWithSort, 0);
+        RegisterBenchmark(group, "single", runSelectSingleThread, 0);
+        RegisterBenchmark(group, "sample_select", runSelectWithSampling, 1);
+        RegisterBenchmark(group, "radix_select", runSelectWithRadix, 1);
+    }
+}
@@ -0,0 +1,24 @@
+#ifndef OPENMP_VECTOR_SELECT_H
+#define OPENMP_VECTOR_SELECT_H
+#endif
+
+/*
+ * k-th smallest element (k counted from 0) and the k largest elements of
+ * an int vector. None of the functions modify vector; scratch space is
+ * allocated per call.
+ */
+
+int SelectKthWithSort(int *vector, int size, int k);
+
+int SelectKthSingleThread(int *vector, int size, int k);
+
+int SelectKthWithSampling(int *vector, int size, int k);
+
+int SelectKthWithRadix(int *vector, int size, int k);
+
+// Writes the k largest elements to top, largest first.
+void FindTopKWithSort(int *vector, int size, int k, int *top);
+
+void FindTopKWithHeaps(int *vector, int size, int k, int *top);
+
+void RegisterSelectBenchmarks();
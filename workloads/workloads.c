@@ -0,0 +1,155 @@
+#include "workloads.h"
+#include "malloc.h"
+#include "math.h"
+
+#define MEMORY_BUFFER_SIZE (1 << 24)
+#define BIMODAL_HEAVY_FACTOR 10
+
+static unsigned int nextRandom(unsigned int *state)
+{
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static double nextUniform(unsigned int *state)
+{
+    return (nextRandom(state) + 0.5) / 4294967296.0;
+}
+
+static int sampleCost(CostProfile profile, int iteration, int numIterations, int meanCost, double shape, unsigned int *state)
+{
+    switch (profile)
+    {
+    case COST_INCREASING:
+        return numIterations > 1
+                   ? 1 + (int)((2.0 * meanCost - 2) * iteration / (numIterations - 1))
+                   : meanCost;
+    case COST_PARETO:
+    {
+        double minCost = meanCost * (shape - 1) / shape;
+        return (int)(minCost / pow(nextUniform(state), 1.0 / shape));
+    }
+    case COST_BIMODAL:
+    {
+        double light = meanCost / (1 + (BIMODAL_HEAVY_FACTOR - 1) * shape);
+        return (int)(nextUniform(state) < shape ? light * BIMODAL_HEAVY_FACTOR : light);
+    }
+    case COST_UNIFORM:
+    default:
+        return meanCost;
+    }
+}
+
+Workload *InitWorkload(CostProfile profile, BodyKind body, int numIterations, int meanCost, double shape)
+{
+    Workload *workload = malloc(sizeof(Workload));
+    workload->profile = profile;
+    workload->body = body;
+    workload->numIterations = numIterations;
+    workload->costs = malloc(sizeof(int) * numIterations);
+    workload->prefixCosts = malloc(sizeof(long long) * (numIterations + 1));
+    workload->totalCost = 0;
+    workload->maxCost = 0;
+
+    unsigned int state = 0x9E3779B9u;
+    for (int i = 0; i < numIterations; i++)
+    {
+        int cost = sampleCost(profile, i, numIterations, meanCost, shape, &state);
+        if (cost < 1)
+        {
+            cost = 1;
+        }
+        workload->costs[i] = cost;
+        workload->prefixCosts[i] = workload->totalCost;
+        workload->totalCost += cost;
+        if (cost > workload->maxCost)
+        {
+            workload->maxCost = cost;
+        }
+    }
+    workload->prefixCosts[numIterations] = workload->totalCost;
+
+    workload->buffer = NULL;
+    workload->bufferSize = 0;
+    if (body == BODY_MEMORY)
+    {
+        workload->bufferSize = MEMORY_BUFFER_SIZE;
+        workload->buffer = malloc(sizeof(int) * MEMORY_BUFFER_SIZE);
+        for (int i = 0; i < MEMORY_BUFFER_SIZE; i++)
+        {
+            workload->buffer[i] = (int)nextRandom(&state);
+        }
+    }
+    return workload;
+}
+
+static int computeBody(int iteration, int cost)
+{
+    double x = iteration;
+    for (int unit = 0; unit < cost; unit++)
+    {
+        x = x * 1.0000001 + 0.5;
+        x = x * 0.9999999 - 0.25;
+    }
+    return (int)x;
+}
+
+static int memoryBody(const int *buffer, int bufferSize, int iteration, int cost)
+{
+    unsigned int index = (unsigned int)iteration * 2654435761u;
+    int sum = 0;
+    for (int unit = 0; unit < cost; unit++)
+    {
+        index = (index * 1103515245u + 12345u + (unsigned int)buffer[index & (bufferSize - 1)]);
+        sum += buffer[index & (bufferSize - 1)];
+    }
+    return sum;
+}
+
+int RunWorkloadIteration(Workload *workload, int iteration)
+{
+    int cost = workload->costs[iteration];
+    if (workload->body == BODY_MEMORY)
+    {
+        return memoryBody(workload->buffer, workload->bufferSize, iteration, cost);
+    }
+    return computeBody(iteration, cost);
+}
+
+const char *GetCostProfileName(CostProfile profile)
+{
+    switch (profile)
+    {
+    case COST_UNIFORM:
+        return "uniform";
+    case COST_INCREASING:
+        return "increasing";
+    case COST_PARETO:
+        return "pareto";
+    case COST_BIMODAL:
+        return "bimodal";
+    default:
+        return "unknown";
+    }
+}
+
+const char *GetBodyKindName(BodyKind body)
+{
+    return body == BODY_MEMORY ? "memory" : "compute";
+}
+
+void FreeWorkload(Workload *workload)
+{
+    free(workload->costs);
+    free(workload->prefixCosts);
+    free(workload->buffer);
+    workload->costs = NULL;
+    workload->prefixCosts = NULL;
+    workload->buffer = NULL;
+    workload->numIterations = 0;
+    free(workload);
+}
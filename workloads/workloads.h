@@ -0,0 +1,50 @@
+#ifndef OPENMP_WORKLOADS_H
+#define OPENMP_WORKLOADS_H
+#endif
+
+typedef enum CostProfile
+{
+    COST_UNIFORM,
+    COST_INCREASING,
+    COST_PARETO,
+    COST_BIMODAL
+} CostProfile;
+
+typedef enum BodyKind
+{
+    BODY_COMPUTE,
+    BODY_MEMORY
+} BodyKind;
+
+/*
+ * Synthetic loop with a precomputed cost (in work units) for every iteration.
+ * Costs are generated once from a fixed seed, so totalCost and maxCost are
+ * known before the loop runs and any schedule can be compared to the ideal
+ * makespan max(totalCost / numThreads, maxCost). prefixCosts[i] holds the
+ * cost of iterations [0, i) and lets cost-aware schedules split the loop.
+ *
+ * shape is profile specific: alpha for COST_PARETO, the fraction of heavy
+ * iterations for COST_BIMODAL; it is ignored by the other profiles.
+ */
+typedef struct Workload
+{
+    CostProfile profile;
+    BodyKind body;
+    int numIterations;
+    int *costs;
+    long long *prefixCosts;
+    long long totalCost;
+    int maxCost;
+    int *buffer;
+    int bufferSize;
+} Workload;
+
+Workload *InitWorkload(CostProfile profile, BodyKind body, int numIterations, int meanCost, double shape);
+
+int RunWorkloadIteration(Workload *workload, int iteration);
+
+const char *GetCostProfileName(CostProfile profile);
+
+const char *GetBodyKindName(BodyKind body);
+
+void FreeWorkload(Workload *workload);